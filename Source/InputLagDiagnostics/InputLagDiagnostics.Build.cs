@@ -11,10 +11,27 @@ public class InputLagDiagnostics : ModuleRules
                 "CoreUObject",
                 "Engine",
                 "InputCore",
+                "RenderCore",
+                "RHI",
                 "Slate",
                 "SlateCore",
                 "UnrealTournament"
             }
         );
+
+        // Compile-time features (see InputLagFeatures.h); set one to false to strip it from the build
+        bool bWithLogging = true;
+        bool bWithPercentiles = true;
+        bool bWithHUD = true;
+        bool bWithStageTiming = true;
+        bool bWithHitConfirm = true;
+        bool bWithAudioLatency = true;
+
+        Definitions.Add("INPUTLAG_WITH_LOGGING=" + (bWithLogging ? "1" : "0"));
+        Definitions.Add("INPUTLAG_WITH_PERCENTILES=" + (bWithPercentiles ? "1" : "0"));
+        Definitions.Add("INPUTLAG_WITH_HUD=" + (bWithHUD ? "1" : "0"));
+        Definitions.Add("INPUTLAG_WITH_STAGE_TIMING=" + (bWithStageTiming ? "1" : "0"));
+        Definitions.Add("INPUTLAG_WITH_HIT_CONFIRM=" + (bWithHitConfirm ? "1" : "0"));
+        Definitions.Add("INPUTLAG_WITH_AUDIO_LATENCY=" + (bWithAudioLatency ? "1" : "0"));
     }
 }
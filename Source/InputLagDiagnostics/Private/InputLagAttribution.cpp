@@ -0,0 +1,72 @@
+#include "InputLagDiagnostics.h"
+#include "InputLagAttribution.h"
+
+namespace
+{
+	// Weight kept by older samples on each new one (about 100 samples of memory)
+	const double SampleDecay = 0.99;
+}
+
+FString FInputLagBreakdown::Describe() const
+{
+	return FString::Printf(TEXT("%.0f ms = %.0f wait + %.1f frames x %.1f ms + %.0f queue %c %.0f other"),
+		LagMs, WaitMs, Frames, FrameTimeMs, QueueMs, OtherMs < 0.0f ? TEXT('-') : TEXT('+'), FMath::Abs(OtherMs));
+}
+
+FInputLagAttribution::FSums::FSums()
+	: Weight(0.0)
+	, Lag(0.0)
+	, Wait(0.0)
+	, Frames(0.0)
+	, FrameTime(0.0)
+	, Queue(0.0)
+{
+}
+
+void FInputLagAttribution::FSums::Add(float LagMs, float WaitMs, int32 InFrames, float FrameTimeMs, float QueueMs)
+{
+	Weight = Weight * SampleDecay + 1.0;
+	Lag = Lag * SampleDecay + LagMs;
+	Wait = Wait * SampleDecay + WaitMs;
+	Frames = Frames * SampleDecay + InFrames;
+	FrameTime = FrameTime * SampleDecay + FrameTimeMs;
+	Queue = Queue * SampleDecay + QueueMs;
+}
+
+FInputLagBreakdown FInputLagAttribution::FSums::GetBreakdown() const
+{
+	FInputLagBreakdown Breakdown;
+	if (Weight <= 0.0)
+	{
+		return Breakdown;
+	}
+
+	Breakdown.LagMs = (float)(Lag / Weight);
+	Breakdown.WaitMs = (float)(Wait / Weight);
+	Breakdown.Frames = (float)(Frames / Weight);
+	Breakdown.FrameTimeMs = (float)(FrameTime / Weight);
+	Breakdown.QueueMs = (float)(Queue / Weight);
+
+	// Whatever is left makes the parts add up to the lag exactly
+	Breakdown.OtherMs = Breakdown.LagMs - Breakdown.WaitMs - Breakdown.Frames * Breakdown.FrameTimeMs - Breakdown.QueueMs;
+	return Breakdown;
+}
+
+FInputLagAttribution::FInputLagAttribution()
+{
+}
+
+void FInputLagAttribution::AddSample(float LagMs, float WaitMs, int32 Frames, float FrameTimeMs, float QueueMs, bool bTail)
+{
+	AllSums.Add(LagMs, WaitMs, Frames, FrameTimeMs, QueueMs);
+	if (bTail)
+	{
+		TailSums.Add(LagMs, WaitMs, Frames, FrameTimeMs, QueueMs);
+	}
+}
+
+void FInputLagAttribution::Reset()
+{
+	AllSums = FSums();
+	TailSums = FSums();
+}
@@ -0,0 +1,140 @@
+#include "InputLagDiagnostics.h"
+#include "InputLagAudioLatency.h"
+#include "AudioDevice.h"
+#include "AudioDeviceManager.h"
+#include "ActiveSound.h"
+#include "AudioThread.h"
+
+namespace
+{
+	// Longest wait for a click's sound before it counts as missed (no ammo, weapon switching)
+	const double MaxSoundWaitSeconds = 0.5;
+
+	// The estimated start can precede the click by up to one audio update
+	const double MaxStartSlackSeconds = 0.05;
+
+	// Unowned sounds this close to the shooter (squared, in Unreal units) are taken as theirs
+	const float MaxOwnerDistanceSquared = 200.0f * 200.0f;
+}
+
+FInputLagAudioLatency::FInputLagAudioLatency()
+	: ProbeState(MakeShareable(new FProbeState()))
+	, PendingSound(nullptr)
+	, PendingPressTime(0.0)
+	, PendingLocation(ForceInitToZero)
+	, MissedCount(0)
+{
+	FMemory::Memzero(PendingOwnerIDs, sizeof(PendingOwnerIDs));
+}
+
+void FInputLagAudioLatency::OnFire(USoundBase* Sound, double PressTime, const AActor* Shooter, const AActor* Weapon)
+{
+	if (PendingSound || !Sound || !Shooter)
+	{
+		return;
+	}
+
+	PendingSound = Sound;
+	PendingPressTime = PressTime;
+	PendingOwnerIDs[0] = Shooter->GetUniqueID();
+	PendingOwnerIDs[1] = Weapon ? Weapon->GetUniqueID() : Shooter->GetUniqueID();
+	PendingLocation = Shooter->GetActorLocation();
+}
+
+void FInputLagAudioLatency::Tick(FAudioDevice* AudioDevice, double Now)
+{
+	FProbeResult Result;
+	while (ProbeState->Results.Pop(Result))
+	{
+		// Results from before a Reset or for an earlier click are dropped
+		if (PendingSound && Result.PressTime == PendingPressTime)
+		{
+			Sketch.Add(FMath::Max((float)((Result.StartTime - Result.PressTime) * 1000.0), 0.0f));
+			PendingSound = nullptr;
+		}
+	}
+
+	if (!PendingSound)
+	{
+		return;
+	}
+
+	if (!AudioDevice || Now - PendingPressTime > MaxSoundWaitSeconds)
+	{
+		MissedCount++;
+		PendingSound = nullptr;
+		return;
+	}
+
+	// One probe at a time, so a busy audio thread does not pile them up
+	if (ProbeState->InFlight.GetValue() > 0)
+	{
+		return;
+	}
+	ProbeState->InFlight.Increment();
+
+	// The device is looked up by handle when the probe runs, in case it was torn down in between
+	TSharedRef<FProbeState, ESPMode::ThreadSafe> State = ProbeState;
+	uint32 DeviceHandle = AudioDevice->DeviceHandle;
+	USoundBase* Sound = PendingSound;
+	double PressTime = PendingPressTime;
+	uint32 ShooterID = PendingOwnerIDs[0];
+	uint32 WeaponID = PendingOwnerIDs[1];
+	FVector ShooterLocation = PendingLocation;
+	FAudioThread::RunCommandOnAudioThread([State, DeviceHandle, Sound, PressTime, ShooterID, WeaponID, ShooterLocation]()
+	{
+		FAudioDeviceManager* DeviceManager = GEngine ? GEngine->GetAudioDeviceManager() : nullptr;
+		FAudioDevice* ProbeDevice = DeviceManager ? DeviceManager->GetAudioDevice(DeviceHandle) : nullptr;
+		if (!ProbeDevice)
+		{
+			State->InFlight.Decrement();
+			return;
+		}
+
+		double ProbeTime = FPlatformTime::Seconds();
+		double FirstStart = 0.0;
+		for (const FActiveSound* ActiveSound : ProbeDevice->GetActiveSounds())
+		{
+			// Playback time only advances once the device has started the sound's sources
+			if (ActiveSound->GetSound() != Sound || ActiveSound->PlaybackTime <= 0.0f)
+			{
+				continue;
+			}
+
+			// Other players firing the same weapon play the same sound
+			uint32 OwnerID = ActiveSound->GetOwnerID();
+			bool bFromShooter = (OwnerID != 0)
+				? (OwnerID == ShooterID || OwnerID == WeaponID)
+				: FVector::DistSquared(ActiveSound->Transform.GetTranslation(), ShooterLocation) <= MaxOwnerDistanceSquared;
+			if (!bFromShooter)
+			{
+				continue;
+			}
+
+			double StartTime = ProbeTime - ActiveSound->PlaybackTime;
+			if (StartTime >= PressTime - MaxStartSlackSeconds && (FirstStart == 0.0 || StartTime < FirstStart))
+			{
+				FirstStart = StartTime;
+			}
+		}
+
+		if (FirstStart > 0.0)
+		{
+			State->Results.Push({ PressTime, FirstStart });
+		}
+		State->InFlight.Decrement();
+	});
+}
+
+void FInputLagAudioLatency::Reset()
+{
+	PendingSound = nullptr;
+	MissedCount = 0;
+	Sketch.Reset();
+}
+
+FString FInputLagAudioLatency::GetSummaryText() const
+{
+	return FString::Printf(TEXT("p50 %.1f / p95 %.1f / p99 %.1f ms, %llu shots, %d missed"),
+		GetPercentile(0.5f), GetPercentile(0.95f), GetPercentile(0.99f), GetCount(), MissedCount);
+}
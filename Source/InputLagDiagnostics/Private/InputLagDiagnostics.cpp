@@ -1,15 +1,22 @@
 #include "InputLagDiagnostics.h"
+#include "InputLagMeasurementService.h"
 
 #define LOCTEXT_NAMESPACE "FInputLagDiagnosticsModule"
 
+FInputLagDiagnosticsModule* FInputLagDiagnosticsModule::Instance = nullptr;
+
 void FInputLagDiagnosticsModule::StartupModule()
 {
-	// This code will execute after your module is loaded into memory
+	Instance = this;
+
+	// Allocate all measurement sessions up front; they live until the module is unloaded
+	Service = MakeUnique<FInputLagMeasurementService>();
 }
 
 void FInputLagDiagnosticsModule::ShutdownModule()
 {
-	// This function may be called during shutdown to clean up your module
+	// Closes any open logs and unregisters frame delegates
+	Service.Reset();
 }
 
 #undef LOCTEXT_NAMESPACE
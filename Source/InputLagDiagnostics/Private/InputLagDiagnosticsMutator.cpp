@@ -3,30 +3,45 @@
 #include "InputLagPlayerController.h"
 #include "InputLagHUD.h"
 #include "InputLagHUDHelper.h"
+#include "InputLagInputProcessor.h"
+#include "InputLagMeasurementService.h"
+#include "InputLagReporter.h"
 #include "UTGameMode.h"
 #include "UTHUD.h"
+#include "UTPlayerState.h"
 #include "Engine/Canvas.h"
+#include "Framework/Application/SlateApplication.h"
+
+namespace
+{
+	// Seconds between checks for local players and HUDs that appeared after BeginPlay
+	const float BindPlayersInterval = 1.0f;
+}
 
 AInputLagDiagnosticsMutator::AInputLagDiagnosticsMutator(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
-	, InputLagDiagnostics(nullptr)
 {
 	bAutoEnableForAllPlayers = true;
+	bMatchReportLogged = false;
 	DisplayName = NSLOCTEXT("InputLagDiagnostics", "InputLagDiagnostics", "Input Lag Diagnostics");
 	Description = NSLOCTEXT("InputLagDiagnostics", "InputLagDiagnosticsDesc", "Enables real-time input lag measurement for mouse inputs");
 	
-	// Enable ticking for this mutator
+	// Ticking is switched on only while a session is measuring (see RefreshPlayerHooks)
 	PrimaryActorTick.bCanEverTick = true;
-	PrimaryActorTick.bStartWithTickEnabled = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
 	PrimaryActorTick.bTickEvenWhenPaused = false;
+
+	// One controller and input component slot per local player
+	BoundControllers.AddZeroed(FInputLagMeasurementService::MaxSessions);
+	InputLagInputComponents.AddZeroed(FInputLagMeasurementService::MaxSessions);
 }
 
 void AInputLagDiagnosticsMutator::Init_Implementation(const FString& Options)
 {
 	Super::Init_Implementation(Options);
 
-	// Create our input lag diagnostics helper (plain C++ class, no inheritance issues)
-	InputLagDiagnostics = new FInputLagDiagnostics();
+	// Sessions are attached per local player as controllers are found. They outlive this
+	// mutator, so history and statistics carry over from the previous map.
 }
 
 void AInputLagDiagnosticsMutator::BeginPlay()
@@ -35,159 +50,426 @@ void AInputLagDiagnosticsMutator::BeginPlay()
 
 	UE_LOG(LogTemp, Warning, TEXT("InputLag Mutator: BeginPlay called"));
 
-	if (bAutoEnableForAllPlayers && InputLagDiagnostics)
+	if (bAutoEnableForAllPlayers)
+	{
+		BindLocalPlayers();
+
+		// Pick up local players that join later (split-screen guests, late controllers) and HUDs
+		// spawned after their controller. Cheap enough at this rate to not need stopping.
+		GetWorldTimerManager().SetTimer(BindPlayersTimerHandle, this, &AInputLagDiagnosticsMutator::BindLocalPlayers, BindPlayersInterval, true);
+	}
+}
+
+void AInputLagDiagnosticsMutator::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// A match left before it ended (map vote, server travel) still gets its report
+	if (Role == ROLE_Authority)
+	{
+		LogMatchReport();
+	}
+
+	// On map change the world takes the reporters down with it
+	if (EndPlayReason == EEndPlayReason::Destroyed)
 	{
-		// Find local player and enable diagnostics
-		for (FConstPlayerControllerIterator Iterator = GetWorld()->GetPlayerControllerIterator(); Iterator; ++Iterator)
+		for (AInputLagReporter* Reporter : Reporters)
 		{
-			APlayerController* PC = Iterator->Get();
-			if (PC && PC->IsLocalPlayerController())
+			if (Reporter && !Reporter->IsPendingKill())
 			{
-				InputLagDiagnostics->PlayerOwner = PC;
-				InputLagDiagnostics->bShowInputLagDiagnostics = true;
-				
-				// Register this mutator for PostRender callbacks (HUD drawing)
-				AHUD* HUD = PC->GetHUD();
-				if (HUD)
-				{
-					HUD->AddPostRenderedActor(this);
-					UE_LOG(LogTemp, Warning, TEXT("InputLag Mutator: Added to PostRenderedActors for HUD drawing"));
-				}
-				
-				PC->ClientMessage(TEXT("Input Lag Diagnostics: Auto-enabled. Type 'mutate showinputlag' to toggle."));
-				UE_LOG(LogTemp, Warning, TEXT("InputLag Mutator: Auto-enabled for player"));
-				break;
+				Reporter->Destroy();
 			}
 		}
 	}
+	Reporters.Empty();
+
+	GetWorldTimerManager().ClearTimer(BindPlayersTimerHandle);
+
+	// Hand the sessions back; they keep their history for the next map
+	FInputLagMeasurementService* Service = FInputLagDiagnosticsModule::Get().GetService();
+	for (int32 Slot = 0; Slot < FInputLagMeasurementService::MaxSessions; ++Slot)
+	{
+		UnbindInputCapture(Slot);
+
+		FInputLagDiagnostics* Session = GetSession(Slot);
+		if (Session)
+		{
+			Session->OnEnabledChanged.Remove(EnabledChangedHandles[Slot]);
+			EnabledChangedHandles[Slot].Reset();
+		}
+		if (Service && Session)
+		{
+			Service->Detach(SessionHandles[Slot], Session->PlayerOwner);
+		}
+		BoundControllers[Slot] = nullptr;
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
-void AInputLagDiagnosticsMutator::Tick(float DeltaTime)
+FInputLagDiagnostics* AInputLagDiagnosticsMutator::GetSession(int32 Slot) const
 {
-	Super::Tick(DeltaTime);
+	FInputLagMeasurementService* Service = FInputLagDiagnosticsModule::Get().GetService();
+	if (!Service || Slot < 0 || Slot >= FInputLagMeasurementService::MaxSessions)
+	{
+		return nullptr;
+	}
+	return Service->Resolve(SessionHandles[Slot]);
+}
+
+FInputLagDiagnostics* AInputLagDiagnosticsMutator::GetSessionFor(APlayerController* PC) const
+{
+	return GetSession(FInputLagMeasurementService::GetLocalPlayerSlot(PC));
+}
 
-	if (!InputLagDiagnostics)
+void AInputLagDiagnosticsMutator::BindLocalPlayers()
+{
+	for (FConstPlayerControllerIterator Iterator = GetWorld()->GetPlayerControllerIterator(); Iterator; ++Iterator)
 	{
-		if (GEngine)
+		APlayerController* PC = Iterator->Get();
+		if (PC && PC->IsLocalPlayerController())
 		{
-			GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Red, TEXT("InputLag: No diagnostics object!"));
+			SetPlayerOwner(PC);
 		}
+	}
+}
+
+void AInputLagDiagnosticsMutator::SetPlayerOwner(APlayerController* PC)
+{
+	FInputLagMeasurementService* Service = FInputLagDiagnosticsModule::Get().GetService();
+	if (!Service || !PC || !PC->IsLocalPlayerController())
+	{
+		return;
+	}
+
+	int32 Slot = FInputLagMeasurementService::GetLocalPlayerSlot(PC);
+	if (Slot == INDEX_NONE)
+	{
+		return;
+	}
+
+	if (BoundControllers[Slot] == PC)
+	{
+		// Already bound; the HUD may not have existed when the controller was first seen
+		RefreshPlayerHooks(Slot);
+		return;
+	}
+
+	UnbindInputCapture(Slot);
+
+	if (!SessionHandles[Slot].IsValid())
+	{
+		SessionHandles[Slot] = Service->Attach(Slot);
+	}
+
+	FInputLagDiagnostics* Session = Service->Resolve(SessionHandles[Slot]);
+	if (!Session)
+	{
 		return;
 	}
 
-	// Find player owner if we don't have one yet
-	if (!InputLagDiagnostics->PlayerOwner)
+	Session->PlayerOwner = PC;
+	BoundControllers[Slot] = PC;
+
+	// Hooks follow the session's enable switch, whoever flips it (mutate, exec, sweep...)
+	if (!EnabledChangedHandles[Slot].IsValid())
+	{
+		EnabledChangedHandles[Slot] = Session->OnEnabledChanged.AddUObject(this, &AInputLagDiagnosticsMutator::RefreshAllPlayerHooks);
+	}
+
+	if (bAutoEnableForAllPlayers && !Session->bShowInputLagDiagnostics)
 	{
-		for (FConstPlayerControllerIterator Iterator = GetWorld()->GetPlayerControllerIterator(); Iterator; ++Iterator)
+		Session->SetEnabled(true);
+		PC->ClientMessage(TEXT("Input Lag Diagnostics: Auto-enabled. Type 'mutate showinputlag' to toggle."));
+		UE_LOG(LogTemp, Warning, TEXT("InputLag Mutator: Auto-enabled for local player %d"), Slot);
+	}
+
+	RefreshPlayerHooks(Slot);
+}
+
+void AInputLagDiagnosticsMutator::RefreshPlayerHooks(int32 Slot)
+{
+	APlayerController* PC = BoundControllers[Slot];
+	FInputLagDiagnostics* Session = GetSession(Slot);
+	bool bActive = PC && !PC->IsPendingKill() && Session && Session->bShowInputLagDiagnostics;
+
+	// Input capture: the preprocessor and input component only exist while measuring
+	if (bActive && !InputLagInputComponents[Slot])
+	{
+		BindInputCapture(PC, Slot);
+	}
+	else if (!bActive)
+	{
+		UnbindInputCapture(Slot);
+	}
+
+	// PostRender callback on this player's HUD (one panel per viewport)
+	AHUD* HUD = PC ? PC->GetHUD() : nullptr;
+	if (HUD)
+	{
+		if (bActive)
 		{
-			APlayerController* PC = Iterator->Get();
-			if (PC && PC->IsLocalPlayerController())
-			{
-				InputLagDiagnostics->PlayerOwner = PC;
-				if (GEngine)
-				{
-					GEngine->AddOnScreenDebugMessage(-1, 2.0f, FColor::Cyan, TEXT("InputLag: Found player owner!"));
-				}
-				break;
-			}
+			HUD->AddPostRenderedActor(this);
+		}
+		else
+		{
+			HUD->RemovePostRenderedActor(this);
 		}
 	}
-	
-	// Update input tracking
-	if (InputLagDiagnostics->PlayerOwner && InputLagDiagnostics->PlayerOwner->PlayerInput)
+
+	// Tick only while any session measures
+	bool bAnyActive = false;
+	for (int32 Index = 0; Index < FInputLagMeasurementService::MaxSessions; ++Index)
 	{
-		InputLagDiagnostics->Tick(DeltaTime);
-		
-		// NOTE: We do NOT finalize here - we wait until PostRenderFor (after rendering)
-		// to get accurate input-to-display latency
+		FInputLagDiagnostics* Other = GetSession(Index);
+		bAnyActive |= BoundControllers[Index] && Other && Other->bShowInputLagDiagnostics;
+	}
+	SetActorTickEnabled(bAnyActive);
+}
+
+void AInputLagDiagnosticsMutator::RefreshAllPlayerHooks()
+{
+	for (int32 Slot = 0; Slot < FInputLagMeasurementService::MaxSessions; ++Slot)
+	{
+		RefreshPlayerHooks(Slot);
+	}
+}
+
+void AInputLagDiagnosticsMutator::BindInputCapture(APlayerController* PC, int32 Slot)
+{
+	// Raw mouse movement: seen per event as Slate pumps it, before the player input stack.
+	// Slate has a single mouse, which always drives the primary local player. This takes over
+	// Slate's only preprocessor slot.
+	if (Slot == 0 && FSlateApplication::IsInitialized())
+	{
+		InputProcessor = MakeShareable(new FInputLagInputProcessor(GetSession(0)));
+		FSlateApplication::Get().SetInputPreProcessor(true, InputProcessor);
+	}
+
+	// Mouse buttons never reach input preprocessors, so listen for presses with a non-blocking,
+	// non-consuming component on top of the owner's stack. It only fires when a press happens.
+	UInputComponent* InputComponent = NewObject<UInputComponent>(PC, TEXT("InputLagInputComponent"));
+	InputComponent->bBlockInput = false;
+	InputComponent->RegisterComponent();
+
+	// Each binding carries its key and this player's slot, so a press only reaches its own session
+	const FKey ButtonKeys[] = { EKeys::LeftMouseButton, EKeys::RightMouseButton };
+	for (const FKey& ButtonKey : ButtonKeys)
+	{
+		FInputKeyBinding Binding(FInputChord(ButtonKey), IE_Pressed);
+		Binding.bConsumeInput = false;
+		Binding.KeyDelegate.GetDelegateForManualSet().BindUObject(this, &AInputLagDiagnosticsMutator::RecordButtonPress, ButtonKey, Slot);
+		InputComponent->KeyBindings.Add(Binding);
+	}
+
+	PC->PushInputComponent(InputComponent);
+	InputLagInputComponents[Slot] = InputComponent;
+}
+
+void AInputLagDiagnosticsMutator::UnbindInputCapture(int32 Slot)
+{
+	if (Slot == 0 && InputProcessor.IsValid())
+	{
+		InputProcessor->ClearDiagnostics();
+
+		// Only clear the slot if nobody installed their own processor over ours since
+		if (FSlateApplication::IsInitialized() && InputProcessor->IsInstalled())
+		{
+			FSlateApplication::Get().SetInputPreProcessor(false);
+		}
+		InputProcessor.Reset();
+	}
+
+	UInputComponent* InputComponent = InputLagInputComponents[Slot];
+	if (InputComponent)
+	{
+		APlayerController* PC = Cast<APlayerController>(InputComponent->GetOwner());
+		if (PC)
+		{
+			PC->PopInputComponent(InputComponent);
+		}
+		InputComponent->DestroyComponent();
+		InputLagInputComponents[Slot] = nullptr;
+	}
+}
+
+void AInputLagDiagnosticsMutator::RecordButtonPress(FKey Key, int32 Slot)
+{
+	FInputLagDiagnostics* Session = GetSession(Slot);
+	if (Session)
+	{
+		Session->OnInputKey(Key, IE_Pressed);
+	}
+}
+
+void AInputLagDiagnosticsMutator::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// Per-frame bookkeeping only - input arrives through the preprocessor and input components
+	for (int32 Slot = 0; Slot < FInputLagMeasurementService::MaxSessions; ++Slot)
+	{
+		FInputLagDiagnostics* Session = GetSession(Slot);
+		if (Session && Session->bShowInputLagDiagnostics && Session->PlayerOwner && Session->PlayerOwner->PlayerInput)
+		{
+			Session->Tick(DeltaTime);
+
+			// NOTE: We do NOT finalize here - we wait until PostRenderFor (after rendering)
+			// to get accurate input-to-display latency
+		}
 	}
-	
 }
 
 void AInputLagDiagnosticsMutator::PostRenderFor(APlayerController* PC, UCanvas* Canvas, FVector CameraPosition, FVector CameraDir)
 {
-	if (!InputLagDiagnostics || !Canvas)
+	// Called once per local player's HUD, so each viewport draws its own player's panel
+	FInputLagDiagnostics* Session = GetSessionFor(PC);
+	if (!Session || !Canvas || Session->PlayerOwner != PC)
 	{
 		return;
 	}
 
 	// Finalize input lag measurement NOW - at the point when the frame is actually being rendered
 	// This gives us true input-to-display latency (from input event to pixels being drawn)
-	InputLagDiagnostics->FinalizeInputLagMeasurement();
+	Session->FinalizeInputLagMeasurement();
 
 	// Only draw if diagnostics are enabled
-	if (!InputLagDiagnostics->bShowInputLagDiagnostics)
+	if (!Session->bShowInputLagDiagnostics)
 	{
 		return;
 	}
 
-	// Get statistics
-	float SmoothedLag = InputLagDiagnostics->SmoothedInputLag;
-	float RawLag = InputLagDiagnostics->RawInputLag;
-	float AvgLag = InputLagDiagnostics->GetAverageInputLag();
-	float MinLag = InputLagDiagnostics->GetMinInputLag();
-	float MaxLag = InputLagDiagnostics->GetMaxInputLag();
-	float P95Lag = InputLagDiagnostics->Get95thPercentileInputLag();
-	
-	// Position on left side of screen
-	float X = 20.0f;
-	float Y = Canvas->ClipY / 2.0f - 80.0f;
-	
-	// Font and colors
-	UFont* Font = GEngine->GetMediumFont();
-	FLinearColor TitleColor = FLinearColor::Yellow;
-	FLinearColor ValueColor = FLinearColor::White;
-	
-	// Draw title
-	Canvas->SetDrawColor(FColor(255, 255, 0, 255));
-	Canvas->DrawText(Font, TEXT("=== Input Lag Diagnostics ==="), X, Y);
-	Y += 20.0f;
-	
-	// Draw smoothed lag
-	FLinearColor Color = SmoothedLag < 20.0f ? FLinearColor::Green : (SmoothedLag < 40.0f ? FLinearColor::Yellow : FLinearColor::Red);
-	Canvas->SetDrawColor(FColor(Color.R * 255, Color.G * 255, Color.B * 255, 255));
-	Canvas->DrawText(Font, FString::Printf(TEXT("Smoothed: %.2f ms"), SmoothedLag), X, Y);
-	Y += 18.0f;
-	
-	// Draw raw lag
-	Canvas->SetDrawColor(FColor(255, 255, 255, 255));
-	Canvas->DrawText(Font, FString::Printf(TEXT("Raw: %.2f ms"), RawLag), X, Y);
-	Y += 18.0f;
-	
-	// Draw average
-	Canvas->DrawText(Font, FString::Printf(TEXT("Average: %.2f ms"), AvgLag), X, Y);
-	Y += 18.0f;
-	
-	// Draw min/max
-	Canvas->DrawText(Font, FString::Printf(TEXT("Min: %.2f ms  Max: %.2f ms"), MinLag, MaxLag), X, Y);
-	Y += 18.0f;
-	
-	// Draw 95th percentile
-	Canvas->DrawText(Font, FString::Printf(TEXT("95th Percentile: %.2f ms"), P95Lag), X, Y);
-	Y += 18.0f;
-	
-	// Draw last tracked key
-	Canvas->SetDrawColor(FColor(200, 200, 200, 255));
-	Canvas->DrawText(Font, FString::Printf(TEXT("Last Input: %s"), *InputLagDiagnostics->LastTrackedInputKey.ToString()), X, Y);
+	Session->Canvas = Canvas;
+	Session->DrawInputLagDiagnostics();
+	Session->Canvas = nullptr;
 }
 
 void AInputLagDiagnosticsMutator::ModifyPlayer_Implementation(APawn* Other, bool bIsNewSpawn)
 {
 	Super::ModifyPlayer_Implementation(Other, bIsNewSpawn);
 	
-	// Ensure our diagnostics helper has reference to the player controller
-	if (InputLagDiagnostics && Other && Other->GetController())
+	// Ensure the player's session has a reference to its controller
+	if (Other && Other->GetController())
 	{
 		APlayerController* PC = Cast<APlayerController>(Other->GetController());
+		if (PC && Role == ROLE_Authority)
+		{
+			EnsureReporter(PC);
+		}
 		if (PC && PC->IsLocalPlayerController())
 		{
-			InputLagDiagnostics->PlayerOwner = PC;
+			SetPlayerOwner(PC);
+		}
+	}
+}
+
+void AInputLagDiagnosticsMutator::EnsureReporter(APlayerController* PC)
+{
+	// Forget reporters whose players have left
+	for (int32 Index = Reporters.Num() - 1; Index >= 0; --Index)
+	{
+		AInputLagReporter* Reporter = Reporters[Index];
+		if (!Reporter || Reporter->IsPendingKill() || !Reporter->GetOwner() || Reporter->GetOwner()->IsPendingKill())
+		{
+			if (Reporter && !Reporter->IsPendingKill())
+			{
+				Reporter->Destroy();
+			}
+			Reporters.RemoveAt(Index);
+		}
+		else if (Reporter->GetOwner() == PC)
+		{
+			return;
 		}
 	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.Owner = PC;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	AInputLagReporter* Reporter = GetWorld()->SpawnActor<AInputLagReporter>(AInputLagReporter::StaticClass(), SpawnParams);
+	if (Reporter)
+	{
+		Reporter->Mutator = this;
+		Reporters.Add(Reporter);
+	}
+}
+
+void AInputLagDiagnosticsMutator::ScoreDamage_Implementation(int32 DamageAmount, AUTPlayerState* Victim, AUTPlayerState* Attacker)
+{
+	Super::ScoreDamage_Implementation(DamageAmount, Victim, Attacker);
+
+	// Hit confirmation for the attacker's latest fire click (self damage is not a hit)
+	if (Attacker && Attacker != Victim && DamageAmount > 0)
+	{
+		for (AInputLagReporter* Reporter : Reporters)
+		{
+			APlayerController* PC = Reporter ? Cast<APlayerController>(Reporter->GetOwner()) : nullptr;
+			if (PC && PC->PlayerState == Attacker)
+			{
+				Reporter->ConfirmHit();
+				break;
+			}
+		}
+	}
+}
+
+void AInputLagDiagnosticsMutator::NotifyMatchStateChange_Implementation(FName NewState)
+{
+	Super::NotifyMatchStateChange_Implementation(NewState);
+
+	// The match is decided here; the map can stay up for the scoreboard long after
+	if (Role == ROLE_Authority && NewState == MatchState::WaitingPostMatch)
+	{
+		LogMatchReport();
+	}
+}
+
+void AInputLagDiagnosticsMutator::LogMatchReport()
+{
+	if (bMatchReportLogged || MatchSketch.GetTotalCount() == 0)
+	{
+		return;
+	}
+	bMatchReportLogged = true;
+
+	TArray<FString> Lines;
+	GetLatencyReport(Lines);
+	for (const FString& Line : Lines)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("InputLag: %s"), *Line);
+	}
+}
+
+void AInputLagDiagnosticsMutator::ReceiveSketch(APlayerController* PC, const TArray<uint16>& Counts)
+{
+	FString PlayerName = PC->PlayerState ? PC->PlayerState->PlayerName : PC->GetName();
+
+	FInputLagSketch Delta;
+	Delta.MergeCounts(Counts);
+	PlayerSketches.FindOrAdd(PlayerName).Merge(Delta);
+	MatchSketch.Merge(Delta);
+}
+
+void AInputLagDiagnosticsMutator::GetLatencyReport(TArray<FString>& OutLines) const
+{
+	OutLines.Add(FString::Printf(TEXT("Input lag (match): %llu samples, p50 %.1f / p95 %.1f / p99 %.1f ms"),
+		MatchSketch.GetTotalCount(), MatchSketch.GetPercentile(0.5f), MatchSketch.GetPercentile(0.95f), MatchSketch.GetPercentile(0.99f)));
+
+	TArray<FString> PlayerNames;
+	PlayerSketches.GetKeys(PlayerNames);
+	PlayerNames.Sort();
+	for (const FString& PlayerName : PlayerNames)
+	{
+		const FInputLagSketch& Sketch = PlayerSketches.FindChecked(PlayerName);
+		OutLines.Add(FString::Printf(TEXT("  %s: %llu samples, p50 %.1f / p95 %.1f / p99 %.1f ms"),
+			*PlayerName, Sketch.GetTotalCount(), Sketch.GetPercentile(0.5f), Sketch.GetPercentile(0.95f), Sketch.GetPercentile(0.99f)));
+	}
 }
 
 void AInputLagDiagnosticsMutator::Mutate_Implementation(const FString& MutateString, APlayerController* Sender)
 {
+	// Commands act on the sending player's own session. On a listen server remote clients have none:
+	// the sessions, and the CVars their commands change, belong to the host.
+	FInputLagDiagnostics* InputLagDiagnostics = (Sender && Sender->IsLocalController()) ? GetSessionFor(Sender) : nullptr;
+
 	if (MutateString.Equals(TEXT("showinputlag"), ESearchCase::IgnoreCase))
 	{
 		if (InputLagDiagnostics)
@@ -202,6 +484,125 @@ void AInputLagDiagnosticsMutator::Mutate_Implementation(const FString& MutateStr
 			InputLagDiagnostics->ToggleCSVLogging();
 		}
 	}
+	else if (MutateString.Equals(TEXT("verifyinputlag"), ESearchCase::IgnoreCase))
+	{
+		if (InputLagDiagnostics)
+		{
+			InputLagDiagnostics->ToggleVerifiedCameraLag();
+		}
+	}
+	else if (MutateString.StartsWith(TEXT("inputlag "), ESearchCase::IgnoreCase))
+	{
+		// "inputlag <command> [args...]"
+		TArray<FString> Args;
+		MutateString.ParseIntoArrayWS(Args);
+
+		FString Command = Args.IsValidIndex(1) ? Args[1] : FString();
+		if (Command.Equals(TEXT("sampling"), ESearchCase::IgnoreCase))
+		{
+			if (InputLagDiagnostics)
+			{
+				InputLagDiagnostics->SetSamplingMode(Args.IsValidIndex(2) ? Args[2] : FString(), Args.IsValidIndex(3) ? Args[3] : FString());
+			}
+		}
+		else if (Command.Equals(TEXT("sweep"), ESearchCase::IgnoreCase))
+		{
+			if (InputLagDiagnostics)
+			{
+				InputLagDiagnostics->StartSweep(Args.IsValidIndex(2) ? Args[2] : FString());
+			}
+		}
+		else if (Command.Equals(TEXT("pacing"), ESearchCase::IgnoreCase))
+		{
+			if (InputLagDiagnostics)
+			{
+				InputLagDiagnostics->SetFramePacing(Args.IsValidIndex(2) ? Args[2] : FString());
+			}
+		}
+		else if (Command.Equals(TEXT("latch"), ESearchCase::IgnoreCase))
+		{
+			if (InputLagDiagnostics)
+			{
+				InputLagDiagnostics->ToggleLateLatch();
+			}
+		}
+		else if (Command.Equals(TEXT("polling"), ESearchCase::IgnoreCase))
+		{
+			if (InputLagDiagnostics)
+			{
+				InputLagDiagnostics->ReportPolling();
+			}
+		}
+		else if (Command.Equals(TEXT("injectmouse"), ESearchCase::IgnoreCase))
+		{
+			// The events go into this process's Slate application (local senders only, like every session command)
+			if (InputLagDiagnostics)
+			{
+				InputLagDiagnostics->StartMouseInjection(Args.IsValidIndex(2) ? FCString::Atof(*Args[2]) : 0.0f,
+					Args.IsValidIndex(3) ? FCString::Atof(*Args[3]) : 0.0f);
+			}
+		}
+		else if (Command.Equals(TEXT("hits"), ESearchCase::IgnoreCase))
+		{
+			if (InputLagDiagnostics)
+			{
+				InputLagDiagnostics->ReportHitConfirm();
+			}
+		}
+		else if (Command.Equals(TEXT("attribution"), ESearchCase::IgnoreCase))
+		{
+			if (InputLagDiagnostics)
+			{
+				InputLagDiagnostics->ReportAttribution();
+			}
+		}
+		else if (Command.Equals(TEXT("audio"), ESearchCase::IgnoreCase))
+		{
+			if (InputLagDiagnostics)
+			{
+				InputLagDiagnostics->ReportAudioLatency();
+			}
+		}
+		else if (Command.Equals(TEXT("record"), ESearchCase::IgnoreCase))
+		{
+			if (InputLagDiagnostics)
+			{
+				InputLagDiagnostics->ToggleInputRecording();
+			}
+		}
+		else if (Command.Equals(TEXT("replay"), ESearchCase::IgnoreCase))
+		{
+			if (InputLagDiagnostics)
+			{
+				InputLagDiagnostics->StartInputReplay(Args.IsValidIndex(2) ? Args[2] : FString());
+			}
+		}
+		else if (Command.Equals(TEXT("trace"), ESearchCase::IgnoreCase))
+		{
+			if (InputLagDiagnostics)
+			{
+				InputLagDiagnostics->ToggleTrace();
+			}
+		}
+		else if (Command.Equals(TEXT("report"), ESearchCase::IgnoreCase))
+		{
+			// Server-wide data: listen server host or rcon admins only
+			AUTPlayerState* SenderState = Sender ? Cast<AUTPlayerState>(Sender->PlayerState) : nullptr;
+			if (Sender && (Sender->IsLocalController() || (SenderState && SenderState->bIsRconAdmin)))
+			{
+				TArray<FString> Lines;
+				GetLatencyReport(Lines);
+				for (const FString& Line : Lines)
+				{
+					Sender->ClientMessage(Line);
+				}
+			}
+		}
+		else
+		{
+			Super::Mutate_Implementation(MutateString, Sender);
+		}
+	}
 	else
 	{
 		Super::Mutate_Implementation(MutateString, Sender);
@@ -0,0 +1,232 @@
+#include "InputLagDiagnostics.h"
+#include "InputLagFramePacer.h"
+#include "Engine.h"
+
+namespace
+{
+	// Below this much remaining wait, yield instead of sleeping (OS sleep granularity)
+	const double SpinSeconds = 0.002;
+
+	// Safety margin bounds; doubled on each missed deadline, decayed by MarginDecay per frame on time
+	const double MinSafetyMargin = 0.00025;
+	const double MaxSafetyMargin = 0.004;
+	const double MarginDecay = 0.98;
+
+	// Lateness tolerated before a frame counts as having missed its deadline
+	const double DeadlineTolerance = 0.00025;
+
+	// Deadlines are spaced at least this much wider than the render thread / GPU frame time
+	const double BottleneckHeadroom = 1.05;
+}
+
+FInputLagFramePacer::FInputLagFramePacer()
+	: bEnabled(false)
+	, TargetFPS(0.0f)
+	, TargetPeriod(0.0)
+	, FrameDeadline(0.0)
+	, SmoothedWork(0.0)
+	, WorkDeviation(0.0)
+	, SmoothedBottleneck(0.0)
+	, SafetyMargin(MinSafetyMargin)
+	, WakeTime(0.0)
+	, LastSleepSeconds(0.0)
+	, PacedFrames(0)
+	, MissedDeadlines(0)
+	, bOriginalSmoothFrameRate(false)
+{
+}
+
+bool FInputLagFramePacer::Enable(float InTargetFPS)
+{
+	// Pace to the current cap when no rate is given; without any cap there is no deadline to aim for
+	float NewTargetFPS = (InTargetFPS > 0.0f) ? InTargetFPS
+		: (bEnabled ? TargetFPS : FCString::Atof(*GetConsoleVariable(TEXT("t.MaxFPS"))));
+	if (NewTargetFPS <= 0.0f)
+	{
+		return false;
+	}
+
+	if (!bEnabled)
+	{
+		// The engine limiter would sleep again on top of the pacer, so it is switched off while pacing
+		OriginalMaxFPS = GetConsoleVariable(TEXT("t.MaxFPS"));
+		bOriginalSmoothFrameRate = GEngine ? GEngine->bSmoothFrameRate : false;
+		SetConsoleVariable(TEXT("t.MaxFPS"), TEXT("0"));
+		if (GEngine)
+		{
+			GEngine->bSmoothFrameRate = false;
+		}
+
+		PacedSketch.Reset();
+		PacedFrames = 0;
+		MissedDeadlines = 0;
+		SmoothedWork = 0.0;
+		WorkDeviation = 0.0;
+		SmoothedBottleneck = 0.0;
+		SafetyMargin = MinSafetyMargin;
+	}
+
+	bEnabled = true;
+	TargetFPS = NewTargetFPS;
+	TargetPeriod = 1.0 / TargetFPS;
+	FrameDeadline = 0.0;
+	WakeTime = 0.0;
+
+	UE_LOG(LogTemp, Warning, TEXT("InputLag: Frame pacing enabled at %.0f fps (engine limiter was t.MaxFPS=%s)"), TargetFPS, *OriginalMaxFPS);
+	return true;
+}
+
+void FInputLagFramePacer::Disable()
+{
+	if (!bEnabled)
+	{
+		return;
+	}
+
+	bEnabled = false;
+	SetConsoleVariable(TEXT("t.MaxFPS"), OriginalMaxFPS);
+	if (GEngine)
+	{
+		GEngine->bSmoothFrameRate = bOriginalSmoothFrameRate;
+	}
+
+	UE_LOG(LogTemp, Warning, TEXT("InputLag: Frame pacing disabled after %d frames (%d missed deadlines)"), PacedFrames, MissedDeadlines);
+	if (HasComparison())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("InputLag: Frame pacing p50 %.1f -> %.1f ms, %s"),
+			GetBaselinePercentile(0.5f), GetPacedPercentile(0.5f), *GetComparisonText());
+	}
+
+	// The next comparison starts from a fresh unpaced baseline
+	BaselineSketch.Reset();
+}
+
+void FInputLagFramePacer::OnBeginFrame()
+{
+	if (!bEnabled)
+	{
+		return;
+	}
+
+	double Now = FPlatformTime::Seconds();
+
+	// Deadlines are spaced by the cap, or by the slowest downstream stage if that cannot keep up,
+	// so frames never queue up behind the render thread or GPU after their input was sampled.
+	// Rises are taken immediately, drops are smoothed.
+	double Bottleneck = FMath::Max(CyclesToSeconds(GRenderThreadTime), CyclesToSeconds(GGPUFrameTime));
+	SmoothedBottleneck = (Bottleneck > SmoothedBottleneck) ? Bottleneck : SmoothedBottleneck * 0.95 + Bottleneck * 0.05;
+	TargetPeriod = FMath::Max(1.0 / TargetFPS, SmoothedBottleneck * BottleneckHeadroom);
+
+	// Wake-up leaves room for typical work plus two mean deviations and the adaptive margin
+	double PredictedWork = SmoothedWork + 2.0 * WorkDeviation + SafetyMargin;
+
+	double NextDeadline = FrameDeadline + TargetPeriod;
+	if (FrameDeadline <= 0.0 || NextDeadline - PredictedWork < Now)
+	{
+		// First frame or fallen behind: start now and pace from here
+		NextDeadline = Now + PredictedWork;
+	}
+	FrameDeadline = NextDeadline;
+
+	WakeTime = FMath::Min(FrameDeadline - PredictedWork, Now + TargetPeriod);
+	WaitUntil(WakeTime);
+
+	double Woke = FPlatformTime::Seconds();
+	LastSleepSeconds = Woke - Now;
+	WakeTime = Woke;
+	PacedFrames++;
+}
+
+void FInputLagFramePacer::OnEndFrame()
+{
+	if (!bEnabled || WakeTime <= 0.0)
+	{
+		return;
+	}
+
+	double Now = FPlatformTime::Seconds();
+
+	// Game thread work from wake-up to frame end, smoothed with its mean deviation
+	double Work = Now - WakeTime;
+	if (SmoothedWork <= 0.0)
+	{
+		SmoothedWork = Work;
+	}
+	WorkDeviation = WorkDeviation * 0.9 + FMath::Abs(Work - SmoothedWork) * 0.1;
+	SmoothedWork = SmoothedWork * 0.9 + Work * 0.1;
+
+	if (Now > FrameDeadline + DeadlineTolerance)
+	{
+		// Late: wake earlier from now on and pace the next frame from the actual end
+		MissedDeadlines++;
+		SafetyMargin = FMath::Min(SafetyMargin * 2.0, MaxSafetyMargin);
+		FrameDeadline = Now;
+	}
+	else
+	{
+		SafetyMargin = FMath::Max(SafetyMargin * MarginDecay, MinSafetyMargin);
+	}
+}
+
+void FInputLagFramePacer::AddLagSample(float LagMs, uint32 Weight)
+{
+	(bEnabled ? PacedSketch : BaselineSketch).Add(LagMs, Weight);
+}
+
+bool FInputLagFramePacer::HasComparison() const
+{
+	return BaselineSketch.GetTotalCount() >= MinComparisonSamples && PacedSketch.GetTotalCount() >= MinComparisonSamples;
+}
+
+FString FInputLagFramePacer::GetStatusText() const
+{
+	return FString::Printf(TEXT("%.0f fps (%.1f ms), sleep %.1f ms, work %.1f ms, missed %d/%d"),
+		1.0 / TargetPeriod, TargetPeriod * 1000.0, LastSleepSeconds * 1000.0, SmoothedWork * 1000.0, MissedDeadlines, PacedFrames);
+}
+
+FString FInputLagFramePacer::GetComparisonText() const
+{
+	if (!HasComparison())
+	{
+		return FString();
+	}
+
+	float Before = GetBaselinePercentile(0.95f);
+	float After = GetPacedPercentile(0.95f);
+	float Change = (Before > 0.0f) ? (After - Before) / Before * 100.0f : 0.0f;
+	return FString::Printf(TEXT("p95 %.1f -> %.1f ms (%+.0f%%)"), Before, After, Change);
+}
+
+void FInputLagFramePacer::WaitUntil(double InWakeTime)
+{
+	// FPlatformProcess::Sleep counts as idle time, so engine stats do not book the wait as game thread work
+	for (;;)
+	{
+		double Remaining = InWakeTime - FPlatformTime::Seconds();
+		if (Remaining <= 0.0)
+		{
+			break;
+		}
+		FPlatformProcess::Sleep((Remaining > SpinSeconds) ? (float)(Remaining - SpinSeconds) : 0.0f);
+	}
+}
+
+FString FInputLagFramePacer::GetConsoleVariable(const TCHAR* Name)
+{
+	IConsoleVariable* Variable = IConsoleManager::Get().FindConsoleVariable(Name);
+	return Variable ? Variable->GetString() : FString();
+}
+
+void FInputLagFramePacer::SetConsoleVariable(const TCHAR* Name, const FString& Value)
+{
+	IConsoleVariable* Variable = IConsoleManager::Get().FindConsoleVariable(Name);
+	if (Variable && !Value.IsEmpty())
+	{
+		Variable->Set(*Value, ECVF_SetByConsole);
+	}
+}
+
+double FInputLagFramePacer::CyclesToSeconds(uint32 Cycles)
+{
+	return Cycles * FPlatformTime::GetSecondsPerCycle();
+}
@@ -1,112 +1,1058 @@
 #include "InputLagDiagnostics.h"
 #include "InputLagHUD.h"
+#include "InputLagFramePacer.h"
+#include "InputLagLateLatch.h"
+#include "InputLagFeatures.h"
+#include "InputLagPlayerController.h"
+#include "InputLagCore/InputLagCoreMeasurement.h"
+#include "InputLagCore/InputLagCoreStats.h"
+#include "InputLagCore/InputLagCoreEncoding.h"
+#include "UTCharacter.h"
+#include "UTWeapon.h"
+#include "Framework/Application/SlateApplication.h"
+
+namespace
+{
+	// Weight kept by earlier verified samples in the degrees-per-delta fit
+	const double VerifyCalibrationDecay = 0.95;
+
+	// Squared axis delta needed before the fit is used to check direction and size
+	const double MinVerifyCalibrationSumXX = 200.0;
+
+	// Observed turn may be this many times smaller or larger than the fit predicts
+	const float VerifyRotationTolerance = 3.0f;
+
+	// Clock the measurement core records lag with
+	struct FPlatformTimeSource
+	{
+		static double Now() { return FPlatformTime::Seconds(); }
+	};
+}
 
 FInputLagDiagnostics::FInputLagDiagnostics()
 	: bShowInputLagDiagnostics(false)
 	, bEnableCSVLogging(false)
 	, PlayerOwner(nullptr)
 	, Canvas(nullptr)
-	, LastInputTimestamp(0.0)
-	, InputFrameNumber(0)
-	, LastTrackedInputKey(EKeys::Invalid)
-	, bPendingInputMeasurement(false)
-	, HistoryIndex(0)
-	, SmoothedInputLag(0.0f)
-	, RawInputLag(0.0f)
-	, CSVFileHandle(nullptr)
+	, Players(nullptr)
+	, Slot(0)
+	, FramePacer(nullptr)
+	, bVerifyCameraRotation(false)
+	, InputCameraRotation(ForceInitToZero)
+	, MinVerifiedRotationDegrees(0.001f)
+	, LastInputPhase(-1.0f)
+	, LastQuantizationWaitMs(0.0f)
+	, bStatsDirty(false)
+	, SampleCount(0)
 	, CSVSampleCount(0)
+	, SweepSavedSamplingMode(EInputLagSamplingMode::Auto)
+	, ReplaySavedSamplingMode(EInputLagSamplingMode::Auto)
+	, bReplayPending(false)
+	, bCommandLineReplayChecked(false)
+	, SyntheticYawDirection(1.0f)
+	, InjectionHz(0.0f)
+	, InjectionNextTime(0.0)
+	, InjectionEndTime(0.0)
+	, LastTickFrame(0)
+	, LatchSampleSequence(0)
+	, LatchSampleInputTime(0.0)
+	, LatchSampleUnlatchedMs(0.0f)
+	, LatchSampleFrame(0)
+{
+	// Pre-allocate phase bins (history and pending state live in the service's player table)
+	PhaseBinCounts.AddZeroed(NumPhaseBins);
+	PhaseBinLagSum.AddZeroed(NumPhaseBins);
+	PhaseBinWaitSum.AddZeroed(NumPhaseBins);
+	RenderSamples.Reserve(FInputLagRenderStamps::Capacity);
+
+	FMemory::Memzero(VerifySumXY, sizeof(VerifySumXY));
+	FMemory::Memzero(VerifySumXX, sizeof(VerifySumXX));
+}
+
+FInputLagDiagnostics::~FInputLagDiagnostics()
+{
+	Trace.Stop();
+	CSVWriter.Close();
+}
+
+void FInputLagDiagnostics::BindPlayerSlot(FInputLagPlayerTable* InPlayers, int32 InSlot)
+{
+	Players = InPlayers;
+	Slot = InSlot;
+}
+
+void FInputLagDiagnostics::OnInputKey(FKey Key, EInputEvent EventType)
+{
+	if (!bShowInputLagDiagnostics)
+	{
+		return;
+	}
+
+	FInputLagScopedWork ScopedWork(Sampler);
+
+	// Every fire click (not just sampled ones) is tagged for hit confirmation and probed for its sound
+	if (EventType == IE_Pressed && (Key == EKeys::LeftMouseButton || Key == EKeys::RightMouseButton))
+	{
+		double Now = FPlatformTime::Seconds();
+
+		// The owner's reporter sends the tag next to the fire RPC
+		if (FInputLagFeatures::bHitConfirm)
+		{
+			uint16 FireTag = HitConfirm.TagClick(Now, GFrameCounter);
+			if (FireTag != 0)
+			{
+				OnFireTagged.Broadcast(FireTag);
+			}
+		}
+
+		// Left and right mouse fire the weapon's first and second fire modes
+		if (FInputLagFeatures::bAudioLatency)
+		{
+			AUTCharacter* Character = PlayerOwner ? Cast<AUTCharacter>(PlayerOwner->GetPawn()) : nullptr;
+			AUTWeapon* Weapon = Character ? Character->GetWeapon() : nullptr;
+			int32 FireMode = (Key == EKeys::LeftMouseButton) ? 0 : 1;
+			if (Weapon && Weapon->FireSound.IsValidIndex(FireMode))
+			{
+				AudioLatency.OnFire(Weapon->FireSound[FireMode], Now, Character, Weapon);
+			}
+		}
+	}
+
+	// Record timestamp for mouse button presses (repeats are not new presses, and the mutator's
+	// input component only sees IE_Pressed, so both paths measure the same events)
+	if (EventType == IE_Pressed && (Key == EKeys::LeftMouseButton || Key == EKeys::RightMouseButton))
+	{
+		// Still offered while a measurement is in flight, so sampling weights cover every press
+		if (Players->PendingMeasurement[Slot])
+		{
+			Sampler.CountBusyOffer();
+			return;
+		}
+
+		double Now = FPlatformTime::Seconds();
+		if (!Sampler.ShouldSample(Now))
+		{
+			return;
+		}
+
+		Players->InputTimestamp[Slot] = Now;
+		Players->InputFrame[Slot] = GFrameCounter;
+		Players->TrackedKey[Slot] = Key;
+		Players->PendingMeasurement[Slot] = true;
+		Players->InputFrameStart[Slot] = Players->CurrentFrameStart;
+		Players->InputFrameEnd[Slot] = 0.0;
+		if (FInputLagFeatures::bStageTiming)
+		{
+			Trace.BeginInput(Key, Now, GFrameCounter);
+		}
+	}
+}
+
+void FInputLagDiagnostics::OnInputAxis(FKey Key, float Delta)
+{
+	if (!bShowInputLagDiagnostics)
+	{
+		return;
+	}
+
+	if (Key != EKeys::MouseX && Key != EKeys::MouseY)
+	{
+		return;
+	}
+
+	FInputLagScopedWork ScopedWork(Sampler);
+
+	// Record timestamp for mouse movement
+	if (!Players->PendingMeasurement[Slot])
+	{
+		double Now = FPlatformTime::Seconds();
+		if (!Sampler.ShouldSample(Now))
+		{
+			return;
+		}
+
+		Players->InputTimestamp[Slot] = Now;
+		Players->InputFrame[Slot] = GFrameCounter;
+		Players->TrackedKey[Slot] = Key;
+		Players->PendingMeasurement[Slot] = true;
+		Players->InputFrameStart[Slot] = Players->CurrentFrameStart;
+		Players->InputFrameEnd[Slot] = 0.0;
+		if (FInputLagFeatures::bStageTiming)
+		{
+			Trace.BeginInput(Key, Now, GFrameCounter);
+		}
+
+		// Late-latch sequence of this movement, to find the render-thread frame that first applied it
+		Players->LatchSequence[Slot] = (LateLatch.IsValid() && LateLatch->IsEnabled()) ? LateLatch->GetSequence() : 0;
+
+		// Remember where the camera was looking so we can tell when the rotation actually changes
+		Players->PendingAxisDelta[Slot] = Delta;
+		InputCameraRotation = GetCameraViewRotation();
+	}
+	else
+	{
+		Sampler.CountBusyOffer();
+
+		// Keep accumulating while we wait for the camera to catch up
+		if (bVerifyCameraRotation && Key == Players->TrackedKey[Slot])
+		{
+			Players->PendingAxisDelta[Slot] += Delta;
+		}
+	}
+}
+
+void FInputLagDiagnostics::OnRawMouseDelta(const FVector2D& Delta)
+{
+	// Forwarded whether or not the overlay is showing, the view depends on it
+	if (LateLatch.IsValid() && LateLatch->IsEnabled())
+	{
+		LateLatch->AddRawDelta(Delta.X, Delta.Y);
+	}
+
+	if (bShowInputLagDiagnostics)
+	{
+		Polling.AddRawEvent(FPlatformTime::Seconds());
+	}
+}
+
+void FInputLagDiagnostics::OnInputAxisSamples(FKey Key, int32 NumSamples)
+{
+	if (bShowInputLagDiagnostics && (Key == EKeys::MouseX || Key == EKeys::MouseY))
+	{
+		Polling.AddAxisCall(NumSamples);
+	}
+}
+
+void FInputLagDiagnostics::UpdateLateLatch()
+{
+	if (!LateLatch.IsValid() || !LateLatch->IsEnabled() || !PlayerOwner)
+	{
+		return;
+	}
+
+	// Only latch while mouse movement turns the camera
+	bool bLookActive = !PlayerOwner->IsLookInputIgnored() && !PlayerOwner->IsPaused() && !PlayerOwner->bShowMouseCursor;
+	LateLatch->UpdateCalibration(GetCameraViewRotation(), PlayerOwner->GetViewTarget(), bLookActive);
+
+	ResolveLatchedSample(GFrameCounter - LatchSampleFrame > MaxLatchResolveFrames);
+}
+
+void FInputLagDiagnostics::ResolveRenderSamples()
+{
+	// Stamps complete in order, so the first one still out holds back the rest
+	while (RenderSamples.Num() > 0)
+	{
+		const FInputLagRenderSample& Sample = RenderSamples[0];
+		double RenderTime = 0.0;
+		if (!RenderStamps.GetTime(Sample.StampSequence, RenderTime))
+		{
+			return;
+		}
+
+		// Game frames from the input's frame to the one running when the render thread got through the
+		// measured frame; this is where a render thread falling a frame behind shows up
+		uint64 RenderFrame = 0;
+		double RenderFrameStart = 0.0;
+		bool bFrameKnown = RenderStamps.FindFrame(RenderTime, RenderFrame, RenderFrameStart) && RenderFrame > Sample.InputFrame;
+		uint64 Frames = bFrameKnown ? RenderFrame - Sample.InputFrame : 1;
+		if (PipelineDepth.AddSample(Frames, RenderTime))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("InputLag: Pipeline depth changed from %d to %d frames (p95 now %.1f ms, frames %s)"),
+				PipelineDepth.GetPreviousDepth(), PipelineDepth.GetDepth(), Get95thPercentileInputLag(), *PipelineDepth.GetHistogramText());
+		}
+
+		// Input to the render thread finishing its frame: the wait for the input's frame to end, the
+		// whole game frames after it, and the queueing into the frame the render thread finished in
+		if (bFrameKnown && Sample.Phase >= 0.0f)
+		{
+			float RenderLagMs = (float)((RenderTime - Sample.InputTime) * 1000.0);
+			float QueueMs = (float)((RenderTime - RenderFrameStart) * 1000.0);
+			Attribution.AddSample(RenderLagMs, Sample.QuantizationWaitMs, (int32)Frames - 1, Sample.FrameTimeMs, QueueMs, Sample.bTail);
+		}
+
+		WriteCSVEntry(Sample, Frames);
+		RenderSamples.RemoveAt(0, 1, false);
+	}
+}
+
+void FInputLagDiagnostics::ResetRenderSamples()
+{
+	// Samples still waiting on the render thread keep their log rows, without a frame count; stamps
+	// still in flight complete on their own and are ignored
+	for (const FInputLagRenderSample& Sample : RenderSamples)
+	{
+		WriteCSVEntry(Sample, 0);
+	}
+	RenderSamples.Reset();
+	PipelineDepth.Reset();
+	Attribution.Reset();
+}
+
+void FInputLagDiagnostics::ResolveLatchedSample(bool bFinal)
+{
+	if (LatchSampleSequence == 0 || !LateLatch.IsValid())
+	{
+		return;
+	}
+
+	// A latched view showed the movement when the render thread applied it; if no view did,
+	// the movement waited for its game-thread frame like before
+	double LatchTime = 0.0;
+	bool bLatched = LateLatch->FindLatchTime(LatchSampleSequence, LatchTime) && LatchTime >= LatchSampleInputTime;
+	if (!bLatched && !bFinal)
+	{
+		return;
+	}
+
+	float LatchedMs = bLatched ? FMath::Min((float)((LatchTime - LatchSampleInputTime) * 1000.0), LatchSampleUnlatchedMs) : LatchSampleUnlatchedMs;
+	LatchedLagSketch.Add(LatchedMs);
+	UnlatchedLagSketch.Add(LatchSampleUnlatchedMs);
+	LatchSampleSequence = 0;
+}
+
+FRotator FInputLagDiagnostics::GetCameraViewRotation() const
+{
+	if (PlayerOwner && PlayerOwner->PlayerCameraManager)
+	{
+		return PlayerOwner->PlayerCameraManager->GetCameraRotation();
+	}
+	return FRotator::ZeroRotator;
+}
+
+float FInputLagDiagnostics::GetObservedAxisDegrees() const
+{
+	// Yaw follows MouseX, pitch follows MouseY
+	FRotator CameraDelta = (GetCameraViewRotation() - InputCameraRotation).GetNormalized();
+	return (Players->TrackedKey[Slot] == EKeys::MouseX) ? CameraDelta.Yaw : CameraDelta.Pitch;
+}
+
+bool FInputLagDiagnostics::HasCameraReflectedInput() const
+{
+	// Without a camera manager there is nothing to verify against, fall back to next-frame timing
+	if (!PlayerOwner || !PlayerOwner->PlayerCameraManager)
+	{
+		return true;
+	}
+
+	float ObservedDegrees = GetObservedAxisDegrees();
+	if (FMath::Abs(ObservedDegrees) < MinVerifiedRotationDegrees)
+	{
+		return false;
+	}
+
+	// Until the fit has enough movement behind it only visible motion is required. After that the
+	// turn must go the way the fit says (inversion and sensitivity are in the fit) and be of a
+	// plausible size, so unrelated camera motion does not close the sample.
+	int32 Axis = (Players->TrackedKey[Slot] == EKeys::MouseX) ? 0 : 1;
+	if (VerifySumXX[Axis] < MinVerifyCalibrationSumXX)
+	{
+		return true;
+	}
+
+	float ExpectedDegrees = (float)(VerifySumXY[Axis] / VerifySumXX[Axis]) * Players->PendingAxisDelta[Slot];
+	if (ExpectedDegrees * ObservedDegrees <= 0.0f)
+	{
+		return false;
+	}
+
+	float SizeRatio = FMath::Abs(ObservedDegrees / ExpectedDegrees);
+	return SizeRatio >= 1.0f / VerifyRotationTolerance && SizeRatio <= VerifyRotationTolerance;
+}
+
+void FInputLagDiagnostics::UpdateVerifyCalibration()
+{
+	if (!PlayerOwner || !PlayerOwner->PlayerCameraManager)
+	{
+		return;
+	}
+
+	int32 Axis = (Players->TrackedKey[Slot] == EKeys::MouseX) ? 0 : 1;
+	double Delta = Players->PendingAxisDelta[Slot];
+	VerifySumXY[Axis] = VerifySumXY[Axis] * VerifyCalibrationDecay + GetObservedAxisDegrees() * Delta;
+	VerifySumXX[Axis] = VerifySumXX[Axis] * VerifyCalibrationDecay + Delta * Delta;
+}
+
+void FInputLagDiagnostics::SetEnabled(bool bInEnabled)
+{
+	if (bShowInputLagDiagnostics == bInEnabled)
+	{
+		return;
+	}
+
+	bShowInputLagDiagnostics = bInEnabled;
+
+	// Depth and attribution from an earlier run say nothing about this one
+	ResetRenderSamples();
+
+	if (!bShowInputLagDiagnostics)
+	{
+		ResetPendingMeasurement();
+
+		// Both depend on the per-frame hooks that are about to go away
+		if (Sweep.IsRunning())
+		{
+			StartSweep(TEXT("stop"));
+		}
+		if (LateLatch.IsValid() && LateLatch->IsEnabled())
+		{
+			ToggleLateLatch();
+		}
+		InjectionEndTime = 0.0;
+
+		// Recording and replay run from the player controller's input hooks, which stop looking now
+		if (Recording.IsRecording())
+		{
+			ToggleInputRecording();
+		}
+		if (bReplayPending)
+		{
+			StartInputReplay(TEXT("stop"));
+		}
+	}
+
+	// Owners register or drop their tick, post-render and input hooks
+	OnEnabledChanged.Broadcast();
+}
+
+void FInputLagDiagnostics::ShowInputLag()
+{
+	SetEnabled(!bShowInputLagDiagnostics);
+	
+	// Log to output log
+	UE_LOG(LogTemp, Warning, TEXT("InputLag: Toggled to %s"), bShowInputLagDiagnostics ? TEXT("ON") : TEXT("OFF"));
+	
+	if (PlayerOwner)
+	{
+		if (bShowInputLagDiagnostics)
+		{
+			PlayerOwner->ClientMessage(TEXT("Input Lag Diagnostics: ON - Check left side of screen"));
+		}
+		else
+		{
+			PlayerOwner->ClientMessage(TEXT("Input Lag Diagnostics: OFF"));
+		}
+	}
+}
+
+void FInputLagDiagnostics::ToggleVerifiedCameraLag()
+{
+	bVerifyCameraRotation = !bVerifyCameraRotation;
+
+	// Refit from scratch, sensitivity or inversion may have changed in between
+	FMemory::Memzero(VerifySumXY, sizeof(VerifySumXY));
+	FMemory::Memzero(VerifySumXX, sizeof(VerifySumXX));
+
+	UE_LOG(LogTemp, Warning, TEXT("InputLag: Verified camera lag %s"), bVerifyCameraRotation ? TEXT("ON") : TEXT("OFF"));
+
+	if (PlayerOwner)
+	{
+		if (bVerifyCameraRotation)
+		{
+			PlayerOwner->ClientMessage(TEXT("Input Lag: mouse samples now wait for the camera rotation to change"));
+		}
+		else
+		{
+			PlayerOwner->ClientMessage(TEXT("Input Lag: mouse samples use next-frame timing"));
+		}
+	}
+}
+
+void FInputLagDiagnostics::ToggleLateLatch()
+{
+	if (!LateLatch.IsValid() || !GEngine)
+	{
+		if (PlayerOwner)
+		{
+			PlayerOwner->ClientMessage(TEXT("Input Lag: late latching is only available for the primary local player"));
+		}
+		return;
+	}
+
+	bool bEnable = !LateLatch->IsEnabled();
+	LateLatch->SetEnabled(bEnable);
+	if (bEnable)
+	{
+		GEngine->ViewExtensions.AddUnique(LateLatch);
+		LatchedLagSketch.Reset();
+		UnlatchedLagSketch.Reset();
+		LatchSampleSequence = 0;
+		SetEnabled(true);
+	}
+	else
+	{
+		GEngine->ViewExtensions.Remove(LateLatch);
+	}
+
+	UE_LOG(LogTemp, Warning, TEXT("InputLag: Late latching %s"), bEnable ? TEXT("ON") : TEXT("OFF"));
+	if (!bEnable && UnlatchedLagSketch.GetTotalCount() > 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("InputLag: Late latching p50 %.1f -> %.1f ms, p95 %.1f -> %.1f ms (%llu samples)"),
+			UnlatchedLagSketch.GetPercentile(0.5f), LatchedLagSketch.GetPercentile(0.5f),
+			UnlatchedLagSketch.GetPercentile(0.95f), LatchedLagSketch.GetPercentile(0.95f), UnlatchedLagSketch.GetTotalCount());
+	}
+
+	if (PlayerOwner)
+	{
+		if (bEnable)
+		{
+			PlayerOwner->ClientMessage(TEXT("Input Lag: late latching ON - move the mouse to calibrate"));
+		}
+		else
+		{
+			PlayerOwner->ClientMessage(TEXT("Input Lag: late latching OFF"));
+		}
+	}
+}
+
+void FInputLagDiagnostics::SetSamplingMode(const FString& ModeName, const FString& Param)
+{
+	bool bValid = Sampler.SetModeFromString(ModeName, Param);
+
+	UE_LOG(LogTemp, Warning, TEXT("InputLag: Sampling %s"), bValid ? *Sampler.GetModeName() : TEXT("unchanged (bad arguments)"));
+
+	if (PlayerOwner)
+	{
+		if (bValid)
+		{
+			PlayerOwner->ClientMessage(FString::Printf(TEXT("Input Lag sampling: %s"), *Sampler.GetModeName()));
+		}
+		else
+		{
+			PlayerOwner->ClientMessage(TEXT("Usage: inputlag sampling all | nth <N> | stride <ms> | reservoir | auto [budget_ms]"));
+		}
+	}
+}
+
+void FInputLagDiagnostics::StartSweep(const FString& ProfileName)
+{
+	if (ProfileName.Equals(TEXT("stop"), ESearchCase::IgnoreCase))
+	{
+		if (Sweep.IsRunning())
+		{
+			Sweep.Stop();
+			Sampler.Mode = SweepSavedSamplingMode;
+			if (PlayerOwner)
+			{
+				PlayerOwner->ClientMessage(FString::Printf(TEXT("Input Lag sweep stopped. Report: %s"), *Sweep.GetReportPath()));
+			}
+		}
+		return;
+	}
+
+	if (bReplayPending)
+	{
+		if (PlayerOwner)
+		{
+			PlayerOwner->ClientMessage(TEXT("Input Lag sweep: not available while a replay is running"));
+		}
+		return;
+	}
+
+	// The sweep drives t.MaxFPS itself, which the pacer would fight
+	if (FramePacer && FramePacer->IsEnabled())
+	{
+		SetFramePacing(TEXT("off"));
+	}
+
+	if (!Sweep.IsRunning())
+	{
+		SweepSavedSamplingMode = Sampler.Mode;
+	}
+
+	if (!Sweep.Start(ProfileName))
+	{
+		Sampler.Mode = SweepSavedSamplingMode;
+		if (PlayerOwner)
+		{
+			PlayerOwner->ClientMessage(FString::Printf(TEXT("Input Lag sweep: profile '%s' has no configurations"), *ProfileName));
+		}
+		return;
+	}
+
+	// A sweep needs every input measured and the diagnostics running, and its configurations
+	// change the frame pacing, so the depth and attribution start afresh
+	Sampler.Mode = EInputLagSamplingMode::All;
+	SetEnabled(true);
+	ResetRenderSamples();
+
+	if (PlayerOwner)
+	{
+		PlayerOwner->ClientMessage(FString::Printf(TEXT("Input Lag sweep started: %s"), *Sweep.GetStatusText()));
+	}
+}
+
+void FInputLagDiagnostics::OnHitConfirmed(uint16 FireTag, float ServerMs)
+{
+	if (FInputLagFeatures::bHitConfirm && bShowInputLagDiagnostics)
+	{
+		HitConfirm.Confirm(FireTag, ServerMs, FPlatformTime::Seconds());
+	}
+}
+
+void FInputLagDiagnostics::ReportHitConfirm()
+{
+	if (!FInputLagFeatures::bHitConfirm)
+	{
+		if (PlayerOwner)
+		{
+			PlayerOwner->ClientMessage(TEXT("Input Lag hit confirmation: not available in this build"));
+		}
+		return;
+	}
+
+	TArray<FString> Lines;
+	if (HitConfirm.GetCount() == 0)
+	{
+		Lines.Add(TEXT("Input Lag hit confirmation: no confirmed hits yet"));
+	}
+	else
+	{
+		Lines.Add(FString::Printf(TEXT("Input Lag hit confirmation %s"), *HitConfirm.GetSummaryText(0.5f)));
+		Lines.Add(FString::Printf(TEXT("Input Lag hit confirmation %s"), *HitConfirm.GetSummaryText(0.95f)));
+	}
+
+	for (const FString& Line : Lines)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("InputLag: %s"), *Line);
+		if (PlayerOwner)
+		{
+			PlayerOwner->ClientMessage(Line);
+		}
+	}
+
+	HitConfirm.Reset();
+}
+
+void FInputLagDiagnostics::ReportAttribution()
 {
-	// Pre-allocate circular buffer
-	InputLagHistory.AddZeroed(MaxInputLagSamples);
+	TArray<FString> Lines;
+	if (!Attribution.HasSamples())
+	{
+		Lines.Add(FInputLagFeatures::bStageTiming
+			? TEXT("Input Lag attribution: no samples yet")
+			: TEXT("Input Lag attribution: not available in this build"));
+	}
+	else
+	{
+		Lines.Add(FString::Printf(TEXT("Input Lag attribution avg %s"), *Attribution.GetAverage().Describe()));
+		if (Attribution.HasTail())
+		{
+			Lines.Add(FString::Printf(TEXT("Input Lag attribution p95 %s"), *Attribution.GetTail().Describe()));
+		}
+	}
+
+	for (const FString& Line : Lines)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("InputLag: %s"), *Line);
+		if (PlayerOwner)
+		{
+			PlayerOwner->ClientMessage(Line);
+		}
+	}
+}
+
+void FInputLagDiagnostics::ReportAudioLatency()
+{
+	if (!FInputLagFeatures::bAudioLatency)
+	{
+		if (PlayerOwner)
+		{
+			PlayerOwner->ClientMessage(TEXT("Input Lag audio: not available in this build"));
+		}
+		return;
+	}
+
+	TArray<FString> Lines;
+	if (AudioLatency.GetCount() == 0)
+	{
+		Lines.Add(AudioLatency.GetMissedCount() > 0
+			? FString::Printf(TEXT("Input Lag audio: no fire sound started within the wait (%d shots missed) - is there an audio device?"), AudioLatency.GetMissedCount())
+			: FString(TEXT("Input Lag audio: no shots fired yet")));
+	}
+	else
+	{
+		Lines.Add(FString::Printf(TEXT("Input Lag audio %s"), *AudioLatency.GetSummaryText()));
+		Lines.Add(FString::Printf(TEXT("Input Lag visual average %.1f / p95 %.1f ms (recent history)"),
+			GetAverageInputLag(), Get95thPercentileInputLag()));
+	}
+
+	for (const FString& Line : Lines)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("InputLag: %s"), *Line);
+		if (PlayerOwner)
+		{
+			PlayerOwner->ClientMessage(Line);
+		}
+	}
+
+	AudioLatency.Reset();
+}
+
+void FInputLagDiagnostics::ToggleInputRecording()
+{
+	if (Recording.IsRecording())
+	{
+		int32 NumEvents = Recording.GetEventCount();
+		bool bWritten = Recording.StopRecording();
+		FString Message = bWritten ? FString::Printf(TEXT("Input Lag recording saved: %d events to %s"), NumEvents, *Recording.GetPath())
+			: FString(TEXT("Input Lag recording stopped (nothing recorded or the file could not be written)"));
+		UE_LOG(LogTemp, Warning, TEXT("InputLag: %s"), *Message);
+		if (PlayerOwner)
+		{
+			PlayerOwner->ClientMessage(Message);
+		}
+		return;
+	}
+
+	if (bReplayPending)
+	{
+		if (PlayerOwner)
+		{
+			PlayerOwner->ClientMessage(TEXT("Input Lag recording: not available while a replay is running"));
+		}
+		return;
+	}
+
+	if (!CheckRecordingController(TEXT("recording")))
+	{
+		return;
+	}
+
+	// Events arrive through the player controller's input hooks, which only look while enabled
+	SetEnabled(true);
+	UWorld* World = PlayerOwner ? PlayerOwner->GetWorld() : nullptr;
+	Recording.StartRecording(World ? World->GetMapName() : FString());
+
+	if (PlayerOwner)
+	{
+		PlayerOwner->ClientMessage(TEXT("Input Lag recording started (mutate inputlag record again to save)"));
+	}
+}
+
+void FInputLagDiagnostics::StartInputReplay(const FString& FileName)
+{
+	if (FileName.Equals(TEXT("stop"), ESearchCase::IgnoreCase))
+	{
+		if (bReplayPending)
+		{
+			Recording.StopReplay();
+			Sampler.Mode = ReplaySavedSamplingMode;
+			bReplayPending = false;
+			if (PlayerOwner)
+			{
+				PlayerOwner->ClientMessage(TEXT("Input Lag replay stopped"));
+			}
+		}
+		return;
+	}
+
+	if (Recording.IsRecording() || Sweep.IsRunning() || bReplayPending)
+	{
+		if (PlayerOwner)
+		{
+			PlayerOwner->ClientMessage(TEXT("Input Lag replay: stop the current recording, sweep or replay first"));
+		}
+		return;
+	}
+
+	// Without the controller nothing would pop the events, and held-back live input would never resume
+	if (!CheckRecordingController(TEXT("replay")))
+	{
+		return;
+	}
+
+	if (!Recording.LoadReplay(FileName))
+	{
+		if (PlayerOwner)
+		{
+			PlayerOwner->ClientMessage(FString::Printf(TEXT("Input Lag replay: '%s' is missing or not an input recording"), *FileName));
+		}
+		return;
+	}
+
+	UWorld* World = PlayerOwner ? PlayerOwner->GetWorld() : nullptr;
+	if (World && Recording.GetReplayMapName() != World->GetMapName())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("InputLag: Replaying input recorded on %s on %s"), *Recording.GetReplayMapName(), *World->GetMapName());
+	}
+
+	// Every input measured, so both builds sample the same inputs
+	ReplaySavedSamplingMode = Sampler.Mode;
+	Sampler.Mode = EInputLagSamplingMode::All;
+	SetEnabled(true);
+	ResetPendingMeasurement();
+	Recording.StartReplay(FPlatformTime::Seconds());
+	bReplayPending = true;
+
+	UE_LOG(LogTemp, Warning, TEXT("InputLag: Replaying %d events from %s"), Recording.GetEventCount(), *Recording.GetPath());
+	if (PlayerOwner)
+	{
+		PlayerOwner->ClientMessage(FString::Printf(TEXT("Input Lag replay started: %d events"), Recording.GetEventCount()));
+	}
+}
+
+void FInputLagDiagnostics::StartCommandLineReplay()
+{
+	// The recording is one player's input, so only the primary player replays it
+	if (bCommandLineReplayChecked || Slot != 0)
+	{
+		return;
+	}
+	bCommandLineReplayChecked = true;
+
+	FString ReplayFile;
+	if (FParse::Value(FCommandLine::Get(), TEXT("InputLagReplay="), ReplayFile))
+	{
+		StartInputReplay(ReplayFile);
+	}
+}
+
+bool FInputLagDiagnostics::CheckRecordingController(const TCHAR* Feature) const
+{
+	if (Cast<AInputLagPlayerController>(PlayerOwner))
+	{
+		return true;
+	}
+
+	FString Message = FString::Printf(TEXT("Input Lag %s: needs AInputLagPlayerController as the game's player controller class"), Feature);
+	UE_LOG(LogTemp, Warning, TEXT("InputLag: %s"), *Message);
+	if (PlayerOwner)
+	{
+		PlayerOwner->ClientMessage(Message);
+	}
+	return false;
+}
+
+bool FInputLagDiagnostics::PopReplayEvent(FInputLagRecordedEvent& OutEvent)
+{
+	return Recording.PopDueEvent(FPlatformTime::Seconds(), OutEvent);
+}
+
+void FInputLagDiagnostics::FinishInputReplay()
+{
+	bReplayPending = false;
+	Sampler.Mode = ReplaySavedSamplingMode;
+
+	const FInputLagSketch& Sketch = Recording.GetReplaySketch();
+	FString Summary = FString::Printf(TEXT("Input Lag replay finished: %llu samples, p50 %.1f / p95 %.1f / p99 %.1f ms"),
+		Sketch.GetTotalCount(), Sketch.GetPercentile(0.5f), Sketch.GetPercentile(0.95f), Sketch.GetPercentile(0.99f));
+	UE_LOG(LogTemp, Warning, TEXT("InputLag: %s (%s)"), *Summary, *Recording.GetPath());
+	if (PlayerOwner)
+	{
+		PlayerOwner->ClientMessage(Summary);
+
+		// Unattended comparison runs exit once the numbers are in the log
+		if (FParse::Param(FCommandLine::Get(), TEXT("InputLagReplayQuit")))
+		{
+			PlayerOwner->ConsoleCommand(TEXT("quit"));
+		}
+	}
+}
+
+void FInputLagDiagnostics::ReportPolling()
+{
+	Polling.RefreshStats();
+	FString Summary = Polling.HasStats() ? Polling.GetStats().Describe() : FString(TEXT("not enough mouse movement yet"));
+	UE_LOG(LogTemp, Warning, TEXT("InputLag: Mouse polling: %s"), *Summary);
+	if (PlayerOwner)
+	{
+		PlayerOwner->ClientMessage(FString::Printf(TEXT("Input Lag mouse polling: %s"), *Summary));
+	}
+
+	Polling.Reset();
+}
+
+void FInputLagDiagnostics::StartMouseInjection(float Hz, float Seconds)
+{
+	if (Hz <= 0.0f || Seconds <= 0.0f || !FSlateApplication::IsInitialized())
+	{
+		if (PlayerOwner)
+		{
+			PlayerOwner->ClientMessage(TEXT("Input Lag mouse injection: mutate inputlag injectmouse <hz> <seconds>"));
+		}
+		return;
+	}
+
+	// Start from a clean slate so the summary describes only the injected events
+	SetEnabled(true);
+	Polling.Reset();
+
+	double Now = FPlatformTime::Seconds();
+	InjectionHz = Hz;
+	InjectionNextTime = Now;
+	InjectionEndTime = Now + Seconds;
+
+	if (PlayerOwner)
+	{
+		PlayerOwner->ClientMessage(FString::Printf(TEXT("Input Lag mouse injection: %.0f Hz for %.1f s"), Hz, Seconds));
+	}
+}
+
+void FInputLagDiagnostics::TickMouseInjection(double Now)
+{
+	if (Now >= InjectionEndTime)
+	{
+		InjectionEndTime = 0.0;
+		UE_LOG(LogTemp, Warning, TEXT("InputLag: Mouse injection at %.0f Hz finished"), InjectionHz);
+		ReportPolling();
+		return;
+	}
+
+	// Every event due since the last frame, one count each, alternating so the view does not drift.
+	// Slate routes them through the preprocessor and the viewport exactly like device input.
+	int32 NumEvents = 0;
+	while (InjectionNextTime <= Now && NumEvents < MaxInjectedEventsPerFrame)
+	{
+		FSlateApplication::Get().OnRawMouseMove((int32)SyntheticYawDirection, 0);
+		SyntheticYawDirection = -SyntheticYawDirection;
+		InjectionNextTime += 1.0 / InjectionHz;
+		NumEvents++;
+	}
+
+	// Behind by more than the cap: skip ahead rather than catch up in a burst
+	if (InjectionNextTime <= Now)
+	{
+		InjectionNextTime = Now + 1.0 / InjectionHz;
+	}
 }
 
-void FInputLagDiagnostics::OnInputKey(FKey Key, EInputEvent EventType)
+void FInputLagDiagnostics::SetFramePacing(const FString& Param)
 {
-	if (!bShowInputLagDiagnostics)
+	if (!FramePacer)
 	{
 		return;
 	}
 
-	// Record timestamp for mouse button presses
-	if ((EventType == IE_Pressed || EventType == IE_Repeat))
+	if (Param.Equals(TEXT("off"), ESearchCase::IgnoreCase))
 	{
-		if (!bPendingInputMeasurement && (Key == EKeys::LeftMouseButton || Key == EKeys::RightMouseButton))
+		FString Comparison = FramePacer->GetComparisonText();
+		FramePacer->Disable();
+		if (PlayerOwner)
 		{
-			LastInputTimestamp = FPlatformTime::Seconds();
-			InputFrameNumber = GFrameCounter;
-			LastTrackedInputKey = Key;
-			bPendingInputMeasurement = true;
+			PlayerOwner->ClientMessage(Comparison.IsEmpty() ? FString(TEXT("Input Lag pacing stopped (not enough samples to compare)"))
+				: FString::Printf(TEXT("Input Lag pacing stopped: %s"), *Comparison));
 		}
+		return;
 	}
-}
 
-void FInputLagDiagnostics::OnInputAxis(FKey Key, float Delta)
-{
-	if (!bShowInputLagDiagnostics)
+	if (Sweep.IsRunning())
 	{
+		if (PlayerOwner)
+		{
+			PlayerOwner->ClientMessage(TEXT("Input Lag pacing: not available while a sweep is running"));
+		}
 		return;
 	}
 
-	// Record timestamp for mouse movement
-	if (!bPendingInputMeasurement && (Key == EKeys::MouseX || Key == EKeys::MouseY))
+	// "on" (or nothing) paces to the current frame cap
+	float TargetFPS = Param.Equals(TEXT("on"), ESearchCase::IgnoreCase) ? 0.0f : FCString::Atof(*Param);
+	if (!FramePacer->Enable(TargetFPS))
+	{
+		if (PlayerOwner)
+		{
+			PlayerOwner->ClientMessage(TEXT("Input Lag pacing needs a frame cap: mutate inputlag pacing <fps>"));
+		}
+		return;
+	}
+
+	// The comparison comes from the session's own measurements
+	SetEnabled(true);
+
+	if (PlayerOwner)
 	{
-		LastInputTimestamp = FPlatformTime::Seconds();
-		InputFrameNumber = GFrameCounter;
-		LastTrackedInputKey = Key;
-		bPendingInputMeasurement = true;
+		PlayerOwner->ClientMessage(FString::Printf(TEXT("Input Lag pacing started: %s"), *FramePacer->GetStatusText()));
 	}
 }
 
-void FInputLagDiagnostics::ShowInputLag()
+void FInputLagDiagnostics::TickSweep(float DeltaTime)
 {
-	bShowInputLagDiagnostics = !bShowInputLagDiagnostics;
-	
-	// Log to output log
-	UE_LOG(LogTemp, Warning, TEXT("InputLag: Toggled to %s"), bShowInputLagDiagnostics ? TEXT("ON") : TEXT("OFF"));
-	
-	if (PlayerOwner)
+	int32 Config = Sweep.GetConfigIndex();
+	Sweep.Tick(DeltaTime);
+
+	// Each configuration gets a depth and a breakdown of its own
+	if (Sweep.IsRunning() && Sweep.GetConfigIndex() != Config)
 	{
-		if (bShowInputLagDiagnostics)
-		{
-			PlayerOwner->ClientMessage(TEXT("Input Lag Diagnostics: ON - Check left side of screen"));
-		}
-		else
+		ResetRenderSamples();
+	}
+
+	if (!Sweep.IsRunning())
+	{
+		// Last configuration just finished
+		Sampler.Mode = SweepSavedSamplingMode;
+		if (PlayerOwner)
 		{
-			PlayerOwner->ClientMessage(TEXT("Input Lag Diagnostics: OFF"));
+			PlayerOwner->ClientMessage(FString::Printf(TEXT("Input Lag sweep finished. Report: %s"), *Sweep.GetReportPath()));
 		}
+		return;
+	}
+
+	// Synthetic input: start a measurement and nudge the view so verified camera mode sees it move
+	if (Sweep.WantsSyntheticInput() && !Players->PendingMeasurement[Slot] && PlayerOwner)
+	{
+		OnInputAxis(EKeys::MouseX, SyntheticYawDirection);
+		PlayerOwner->AddYawInput(SyntheticYawDirection * 0.05f);
+		SyntheticYawDirection = -SyntheticYawDirection;
 	}
 }
 
 void FInputLagDiagnostics::Tick(float DeltaTime)
 {
-	// Track input events each frame by checking PlayerInput state
-	if (bShowInputLagDiagnostics && PlayerOwner && PlayerOwner->PlayerInput)
+	// Mutator and player controller may both be attached - only the first tick of a frame counts
+	if (LastTickFrame == GFrameCounter)
 	{
-		// Track mouse button presses (check for key down transitions)
-		if (PlayerOwner->WasInputKeyJustPressed(EKeys::LeftMouseButton) && !bPendingInputMeasurement)
-		{
-			OnInputKey(EKeys::LeftMouseButton, IE_Pressed);
-		}
-		else if (PlayerOwner->WasInputKeyJustPressed(EKeys::RightMouseButton) && !bPendingInputMeasurement)
-		{
-			OnInputKey(EKeys::RightMouseButton, IE_Pressed);
-		}
-		
-		// Track mouse movement (check for axis delta)
-		float MouseX = PlayerOwner->PlayerInput->GetKeyValue(EKeys::MouseX);
-		float MouseY = PlayerOwner->PlayerInput->GetKeyValue(EKeys::MouseY);
-		
-		if (!bPendingInputMeasurement)
-		{
-			if (FMath::Abs(MouseX) > 0.0f)
-			{
-				OnInputAxis(EKeys::MouseX, MouseX);
-			}
-			else if (FMath::Abs(MouseY) > 0.0f)
-			{
-				OnInputAxis(EKeys::MouseY, MouseY);
-			}
-		}
+		return;
+	}
+	LastTickFrame = GFrameCounter;
+
+	// Close the previous frame's measurement budget. Input is no longer polled here - the mutator
+	// feeds OnInputKey/OnInputAxis from event hooks, so frames without input cost nothing.
+	Sampler.BeginFrame();
+
+	// Close the previous frame's raw mouse event count
+	double Now = FPlatformTime::Seconds();
+	Polling.BeginFrame(Now);
+
+	// Place earlier samples' render-thread completion in the game frames they finished during
+	RenderStamps.AddFrameStart(GFrameCounter, Players->CurrentFrameStart);
+	ResolveRenderSamples();
+
+	// Fire clicks from earlier frames have gone out with that frame's net flush
+	if (FInputLagFeatures::bHitConfirm)
+	{
+		HitConfirm.BeginFrame(Players->CurrentFrameStart, GFrameCounter);
+	}
+
+	// Collect and re-arm the audio-thread probe for a fire click waiting on its sound
+	if (FInputLagFeatures::bAudioLatency)
+	{
+		UWorld* World = PlayerOwner ? PlayerOwner->GetWorld() : nullptr;
+		AudioLatency.Tick(World ? World->GetAudioDevice() : nullptr, Now);
+	}
+
+	// Publish once per frame, covering every sample that landed since (the p95 sorts the history,
+	// too much to redo per input) and any sampling-mode switch
+	PublishStats();
+
+	if (InjectionEndTime > 0.0)
+	{
+		TickMouseInjection(Now);
+	}
+
+	// Every recorded event was delivered and the last measurement has closed
+	if (bReplayPending && !Recording.IsReplaying() && !Players->PendingMeasurement[Slot])
+	{
+		FinishInputReplay();
+	}
+
+	// First game-thread tick after the input arrived
+	if (FInputLagFeatures::bStageTiming && Trace.IsActive() && Players->PendingMeasurement[Slot])
+	{
+		Trace.MarkConsumed(FPlatformTime::Seconds(), GFrameCounter);
+	}
+
+	if (Sweep.IsRunning())
+	{
+		TickSweep(DeltaTime);
 	}
 }
 
@@ -115,10 +1061,6 @@ void FInputLagDiagnostics::DrawHUD()
 	// Early exit if no canvas
 	if (!Canvas)
 	{
-		if (bShowInputLagDiagnostics && GEngine)
-		{
-			GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Yellow, TEXT("InputLag DrawHUD: No Canvas"));
-		}
 		return;
 	}
 
@@ -128,148 +1070,291 @@ void FInputLagDiagnostics::DrawHUD()
 	// Draw input lag diagnostics if enabled
 	if (bShowInputLagDiagnostics)
 	{
-		if (GEngine)
-		{
-			GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Green, TEXT("InputLag: Drawing!"));
-		}
 		DrawInputLagDiagnostics();
 	}
 }
 
 void FInputLagDiagnostics::FinalizeInputLagMeasurement()
 {
-	if (!bPendingInputMeasurement)
+	// The camera is final for this frame, so this is where late latching calibrates
+	UpdateLateLatch();
+
+	if (!Players->PendingMeasurement[Slot])
 	{
 		return;
 	}
 
+	FInputLagScopedWork ScopedWork(Sampler);
+
 	// Only measure if we're in a LATER frame than when input was recorded
-	if (GFrameCounter <= InputFrameNumber)
+	if (GFrameCounter <= Players->InputFrame[Slot])
 	{
 		return;
 	}
 
-	// Measure at end of frame rendering
-	double CurrentTime = FPlatformTime::Seconds();
-	float InputLagMs = (CurrentTime - LastInputTimestamp) * 1000.0f;
+	if (FInputLagFeatures::bStageTiming && Trace.IsActive())
+	{
+		Trace.MarkDraw(FPlatformTime::Seconds(), GFrameCounter);
+	}
+
+	// In verified mode mouse-look samples close on the first frame whose camera rotation has moved,
+	// so smoothing, clamping and camera lag are included in the measurement
+	bool bIsMouseAxis = (Players->TrackedKey[Slot] == EKeys::MouseX || Players->TrackedKey[Slot] == EKeys::MouseY);
+	if (bVerifyCameraRotation && bIsMouseAxis && !HasCameraReflectedInput())
+	{
+		// Net-zero movement can never show up on screen, otherwise give the camera a bounded number of frames
+		if (FMath::IsNearlyZero(Players->PendingAxisDelta[Slot]) || GFrameCounter - Players->InputFrame[Slot] > MaxVerifiedCameraFrames)
+		{
+			// Camera never moved (e.g. pitch clamped or deltas cancelled out) - drop the sample
+			ResetPendingMeasurement();
+		}
+		return;
+	}
+	if (bVerifyCameraRotation && bIsMouseAxis)
+	{
+		UpdateVerifyCalibration();
+	}
 
-	// Sanity check
-	if (InputLagMs > 0.0f && InputLagMs < 1000.0f)
+	// Measure at end of frame rendering; implausible samples are dropped by the core
+	double CurrentTime = 0.0;
+	float InputLagMs = InputLagCore::RecordLag<FPlatformTimeSource>(Players->InputTimestamp[Slot], Sampler.GetSampleWeight(),
+		Players->GetHistory(Slot), Players->GetWeights(Slot), Players->HistoryIndex[Slot], MaxInputLagSamples,
+		Players->RawLag[Slot], Players->SmoothedLag[Slot], CurrentTime);
+	if (InputLagMs >= 0.0f)
 	{
-		RawInputLag = InputLagMs;
-		
-		if (SmoothedInputLag == 0.0f)
+		Sampler.AddMeasurement(InputLagMs);
+		Sweep.AddSample(InputLagMs);
+		if (FInputLagFeatures::bPercentiles)
+		{
+			ReportSketch.Add(InputLagMs, FMath::Max(FMath::RoundToInt(Sampler.GetSampleWeight()), 1));
+		}
+		if (bReplayPending)
+		{
+			Recording.AddReplaySample(InputLagMs);
+		}
+		SampleCount++;
+		bStatsDirty = true;
+
+		// Sweeps change the frame-pacing settings underneath, so their samples stay out of the pacing comparison
+		if (FInputLagFeatures::bPercentiles && FramePacer && !Sweep.IsRunning())
+		{
+			FramePacer->AddLagSample(InputLagMs, FMath::Max(FMath::RoundToInt(Sampler.GetSampleWeight()), 1));
+		}
+
+		// Same sample as the render thread saw it. The render thread may still be on the previous
+		// frame, so the latched side is resolved over the next frames.
+		if (FInputLagFeatures::bPercentiles && bIsMouseAxis && Players->LatchSequence[Slot] != 0 && LateLatch.IsValid() && LateLatch->IsCalibrated())
 		{
-			SmoothedInputLag = InputLagMs;
+			ResolveLatchedSample(true);
+			LatchSampleSequence = Players->LatchSequence[Slot];
+			LatchSampleInputTime = Players->InputTimestamp[Slot];
+			LatchSampleUnlatchedMs = InputLagMs;
+			LatchSampleFrame = GFrameCounter;
+		}
+
+		// Phase of the input within its frame, and how long it sat waiting for that frame to end
+		LastInputPhase = FInputLagFeatures::bStageTiming
+			? InputLagCore::GetArrivalPhase(Players->InputTimestamp[Slot], Players->InputFrameStart[Slot], Players->InputFrameEnd[Slot]) : -1.0f;
+		if (LastInputPhase >= 0.0f)
+		{
+			LastQuantizationWaitMs = FMath::Max((float)((Players->InputFrameEnd[Slot] - Players->InputTimestamp[Slot]) * 1000.0), 0.0f);
+
+			int32 Bin = FMath::Min(FMath::FloorToInt(LastInputPhase * NumPhaseBins), NumPhaseBins - 1);
+			PhaseBinCounts[Bin]++;
+			PhaseBinLagSum[Bin] += InputLagMs;
+			PhaseBinWaitSum[Bin] += LastQuantizationWaitMs;
 		}
 		else
 		{
-			SmoothedInputLag = 0.9f * SmoothedInputLag + 0.1f * InputLagMs;
+			// Frame boundary delegates have not fired yet (or stage timing is compiled out)
+			LastQuantizationWaitMs = 0.0f;
 		}
-		
-		InputLagHistory[HistoryIndex] = InputLagMs;
-		HistoryIndex = (HistoryIndex + 1) % MaxInputLagSamples;
 
-		// Write to CSV if logging is enabled
-		WriteCSVEntry(InputLagMs);
+		// The frame count and the log row wait until the render thread is through this frame
+		if (RenderSamples.Num() >= FInputLagRenderStamps::Capacity)
+		{
+			WriteCSVEntry(RenderSamples[0], 0);
+			RenderSamples.RemoveAt(0, 1, false);
+		}
+		FInputLagRenderSample& RenderSample = RenderSamples[RenderSamples.AddDefaulted()];
+		RenderSample.StampSequence = RenderStamps.Stamp();
+		RenderSample.InputFrame = Players->InputFrame[Slot];
+		RenderSample.MeasuredFrame = GFrameCounter;
+		RenderSample.MeasuredAt = FDateTime::Now();
+		RenderSample.LagMs = InputLagMs;
+		RenderSample.Key = Players->TrackedKey[Slot];
+		RenderSample.Phase = LastInputPhase;
+		RenderSample.QuantizationWaitMs = LastQuantizationWaitMs;
+		RenderSample.InputTime = Players->InputTimestamp[Slot];
+		RenderSample.FrameTimeMs = FApp::GetDeltaTime() * 1000.0f;
+		float Percentile95Ms = GetStatsSnapshot().Percentile95Lag;
+		RenderSample.bTail = Percentile95Ms > 0.0f && InputLagMs >= Percentile95Ms;
+		if (FInputLagFeatures::bStageTiming)
+		{
+			Trace.CompleteInput(CurrentTime, GFrameCounter, InputLagMs);
+		}
 	}
 
-	bPendingInputMeasurement = false;
-	LastInputTimestamp = 0.0;
-	InputFrameNumber = 0;
+	ResetPendingMeasurement();
 }
 
-float FInputLagDiagnostics::GetAverageInputLag() const
+void FInputLagDiagnostics::ResetPendingMeasurement()
 {
-	float Sum = 0.0f;
-	int32 ValidSamples = 0;
-	
-	for (float Lag : InputLagHistory)
+	// Anything still open in the trace never produced a sample
+	if (FInputLagFeatures::bStageTiming)
 	{
-		if (Lag > 0.0f)
-		{
-			Sum += Lag;
-			ValidSamples++;
-		}
+		Trace.DropInput(FPlatformTime::Seconds(), GFrameCounter);
 	}
-	
-	return (ValidSamples > 0) ? (Sum / ValidSamples) : 0.0f;
+	Players->ResetPending(Slot);
+	Sampler.DropMeasurement();
 }
 
-float FInputLagDiagnostics::GetLastInputLag() const
+float FInputLagDiagnostics::GetPhaseBinAverageLag(int32 Bin) const
 {
-	int32 LastIndex = (HistoryIndex - 1 + MaxInputLagSamples) % MaxInputLagSamples;
-	return InputLagHistory[LastIndex];
+	if (!PhaseBinCounts.IsValidIndex(Bin) || PhaseBinCounts[Bin] == 0)
+	{
+		return 0.0f;
+	}
+	return (float)(PhaseBinLagSum[Bin] / PhaseBinCounts[Bin]);
 }
 
-float FInputLagDiagnostics::GetMinInputLag() const
+float FInputLagDiagnostics::GetAverageQuantizationWait() const
 {
-	float MinLag = FLT_MAX;
-	bool bFoundValid = false;
-	
-	for (float Lag : InputLagHistory)
+	int32 Count = 0;
+	double WaitSum = 0.0;
+	for (int32 Bin = 0; Bin < NumPhaseBins; ++Bin)
 	{
-		if (Lag > 0.0f)
-		{
-			MinLag = FMath::Min(MinLag, Lag);
-			bFoundValid = true;
-		}
+		Count += PhaseBinCounts[Bin];
+		WaitSum += PhaseBinWaitSum[Bin];
 	}
-	
-	return bFoundValid ? MinLag : 0.0f;
+	return (Count > 0) ? (float)(WaitSum / Count) : 0.0f;
 }
 
-float FInputLagDiagnostics::GetMaxInputLag() const
+float FInputLagDiagnostics::GetQuantizationShare() const
 {
-	float MaxLag = 0.0f;
-	
-	for (float Lag : InputLagHistory)
+	// Fraction of total measured lag spent waiting for the next frame
+	double LagSum = 0.0;
+	double WaitSum = 0.0;
+	for (int32 Bin = 0; Bin < NumPhaseBins; ++Bin)
 	{
-		if (Lag > 0.0f)
-		{
-			MaxLag = FMath::Max(MaxLag, Lag);
-		}
+		LagSum += PhaseBinLagSum[Bin];
+		WaitSum += PhaseBinWaitSum[Bin];
 	}
-	
-	return MaxLag;
+	return (LagSum > 0.0) ? (float)(WaitSum / LagSum) : 0.0f;
 }
 
-float FInputLagDiagnostics::Get95thPercentileInputLag() const
+void FInputLagDiagnostics::LogPhaseSummary() const
 {
-	TArray<float> ValidSamples;
-	ValidSamples.Reserve(MaxInputLagSamples);
-	
-	for (float Lag : InputLagHistory)
+	UE_LOG(LogTemp, Warning, TEXT("InputLag: Lag by arrival phase (frame wait avg %.2f ms, %.0f%% of lag)"),
+		GetAverageQuantizationWait(), GetQuantizationShare() * 100.0f);
+
+	for (int32 Bin = 0; Bin < NumPhaseBins; ++Bin)
 	{
-		if (Lag > 0.0f)
+		if (PhaseBinCounts[Bin] > 0)
 		{
-			ValidSamples.Add(Lag);
+			UE_LOG(LogTemp, Warning, TEXT("InputLag:   phase %.1f-%.1f  n=%d  lag %.2f ms  wait %.2f ms"),
+				(float)Bin / NumPhaseBins, (float)(Bin + 1) / NumPhaseBins, PhaseBinCounts[Bin],
+				GetPhaseBinAverageLag(Bin), (float)(PhaseBinWaitSum[Bin] / PhaseBinCounts[Bin]));
 		}
 	}
-	
-	if (ValidSamples.Num() == 0)
+
+	if (Attribution.HasSamples())
 	{
-		return 0.0f;
+		UE_LOG(LogTemp, Warning, TEXT("InputLag: Attribution avg %s"), *Attribution.GetAverage().Describe());
 	}
-	
-	ValidSamples.Sort();
-	
-	int32 Index = FMath::CeilToInt(ValidSamples.Num() * 0.95f) - 1;
-	Index = FMath::Clamp(Index, 0, ValidSamples.Num() - 1);
-	
-	return ValidSamples[Index];
+	if (Attribution.HasTail())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("InputLag: Attribution p95 %s"), *Attribution.GetTail().Describe());
+	}
+}
+
+void FInputLagDiagnostics::PublishStats()
+{
+	if (!bStatsDirty && Sampler.Mode == StatsSnapshots.GetPublished().SamplingMode)
+	{
+		return;
+	}
+	bStatsDirty = false;
+
+	FInputLagStatsSnapshot& Snapshot = StatsSnapshots.GetWriteBuffer();
+	const float* History = Players->GetHistory(Slot);
+	const float* Weights = Players->GetWeights(Slot);
+
+	Snapshot.FrameNumber = GFrameCounter;
+	Snapshot.SampleCount = SampleCount;
+	Snapshot.SamplingMode = Sampler.Mode;
+
+	// Reservoir mode reports over the whole session, other modes weight each sample by the inputs it stands for
+	if (Sampler.Mode == EInputLagSamplingMode::Reservoir)
+	{
+		Snapshot.AverageLag = Sampler.GetReservoirAverage();
+		Snapshot.Percentile95Lag = FInputLagFeatures::bPercentiles ? Sampler.GetReservoirPercentile(0.95f) : 0.0f;
+	}
+	else
+	{
+		Snapshot.AverageLag = FInputLagSampler::GetWeightedAverage(History, Weights, MaxInputLagSamples);
+		Snapshot.Percentile95Lag = FInputLagFeatures::bPercentiles ? FInputLagSampler::GetWeightedPercentile(History, Weights, MaxInputLagSamples, 0.95f) : 0.0f;
+	}
+
+	Snapshot.LastLag = InputLagCore::RingLast(History, Players->HistoryIndex[Slot], MaxInputLagSamples);
+	Snapshot.MinLag = InputLagCore::MinValue(History, MaxInputLagSamples);
+	Snapshot.MaxLag = InputLagCore::MaxValue(History, MaxInputLagSamples);
+	Snapshot.SmoothedLag = Players->SmoothedLag[Slot];
+	Snapshot.RawLag = Players->RawLag[Slot];
+
+	StatsSnapshots.Publish();
+}
+
+float FInputLagDiagnostics::GetAverageInputLag() const
+{
+	return GetStatsSnapshot().AverageLag;
+}
+
+float FInputLagDiagnostics::GetLastInputLag() const
+{
+	return GetStatsSnapshot().LastLag;
+}
+
+float FInputLagDiagnostics::GetMinInputLag() const
+{
+	return GetStatsSnapshot().MinLag;
+}
+
+float FInputLagDiagnostics::GetMaxInputLag() const
+{
+	return GetStatsSnapshot().MaxLag;
+}
+
+float FInputLagDiagnostics::Get95thPercentileInputLag() const
+{
+	return GetStatsSnapshot().Percentile95Lag;
+}
+
+float FInputLagDiagnostics::GetSmoothedInputLag() const
+{
+	return GetStatsSnapshot().SmoothedLag;
+}
+
+float FInputLagDiagnostics::GetRawInputLag() const
+{
+	return GetStatsSnapshot().RawLag;
+}
+
+const FKey& FInputLagDiagnostics::GetTrackedInputKey() const
+{
+	return Players->TrackedKey[Slot];
 }
 
 void FInputLagDiagnostics::DrawInputLagDiagnostics()
 {
-	if (!Canvas)
+	if (!FInputLagFeatures::bHUD || !Canvas)
 	{
 		return;
 	}
 
 	// Get statistics
-	float SmoothedLag = SmoothedInputLag;
-	float RawLag = RawInputLag;
+	float SmoothedLag = GetSmoothedInputLag();
+	float RawLag = GetRawInputLag();
 	float AverageLag = GetAverageInputLag();
 	float MinLag = GetMinInputLag();
 	float MaxLag = GetMaxInputLag();
@@ -284,9 +1369,20 @@ void FInputLagDiagnostics::DrawInputLagDiagnostics()
 	float LabelX = XPos;
 	float ValueX = XPos + 180.0f;
 
-	// Draw background
-	FCanvasTileItem BackgroundItem(FVector2D(XPos - 10.0f, YPos - 10.0f), 
-		FVector2D(440.0f, LineHeight * 7.0f + 20.0f), FLinearColor(0.0f, 0.0f, 0.0f, 0.7f));
+	// Title, six stat rows, sampling and phase rows always show; mouse, hit, input, sweep, CSV and trace rows only while active
+	bool bShowPacing = FramePacer && FramePacer->IsEnabled();
+	bool bShowLateLatch = LateLatch.IsValid() && LateLatch->IsEnabled();
+	bool bShowPolling = Polling.HasStats();
+	bool bShowHitConfirm = HitConfirm.GetCount() > 0;
+	bool bShowAudio = AudioLatency.GetCount() > 0;
+	bool bShowAttribution = Attribution.HasSamples();
+	bool bShowPipelineDepth = PipelineDepth.GetTotalCount() > 0;
+	bool bShowRecording = Recording.IsRecording() || bReplayPending;
+	float NumLines = 10.0f + (bShowPolling ? 1.0f : 0.0f) + (bShowHitConfirm ? 1.0f : 0.0f) + (bShowAudio ? 1.0f : 0.0f) + (bShowAttribution ? 1.0f : 0.0f) + (bShowPipelineDepth ? 1.0f : 0.0f) + (bShowRecording ? 1.0f : 0.0f) + (Sweep.IsRunning() ? 1.0f : 0.0f) + (bShowPacing ? 2.0f : 0.0f) + (bShowLateLatch ? 1.0f : 0.0f) + (bEnableCSVLogging ? 1.0f : 0.0f) + (Trace.IsActive() ? 1.0f : 0.0f);
+
+	// Draw background (tile items are not offset by the canvas origin, text is - matters for split-screen viewports)
+	FCanvasTileItem BackgroundItem(FVector2D(Canvas->OrgX + XPos - 10.0f, Canvas->OrgY + YPos - 10.0f), 
+		FVector2D(440.0f, LineHeight * NumLines + 20.0f), FLinearColor(0.0f, 0.0f, 0.0f, 0.7f));
 	BackgroundItem.BlendMode = SE_BLEND_Translucent;
 	Canvas->DrawItem(BackgroundItem);
 
@@ -312,8 +1408,9 @@ void FInputLagDiagnostics::DrawInputLagDiagnostics()
 		Canvas->DrawText(Font, Text, X, Y, 1.0f, 1.0f);
 	};
 
-	// Title
-	DrawShadowedText(LabelX, YPos, TEXT("Input Lag Diagnostics"), FLinearColor(1.0f, 1.0f, 0.0f, 1.0f));
+	// Title (secondary local players are labelled so split-screen panels can be told apart)
+	FString Title = (Slot > 0) ? FString::Printf(TEXT("Input Lag Diagnostics - Player %d"), Slot + 1) : FString(TEXT("Input Lag Diagnostics"));
+	DrawShadowedText(LabelX, YPos, Title, FLinearColor(1.0f, 1.0f, 0.0f, 1.0f));
 	YPos += LineHeight;
 
 	// Smoothed (primary display - like stat unit shows smoothed values)
@@ -342,43 +1439,228 @@ void FInputLagDiagnostics::DrawInputLagDiagnostics()
 	YPos += LineHeight;
 
 	// Last tracked input key
-	FString KeyName = LastTrackedInputKey.ToString();
+	FString KeyName = Players->TrackedKey[Slot].ToString();
+	if (bVerifyCameraRotation)
+	{
+		KeyName += TEXT(" (verified camera)");
+	}
 	DrawShadowedText(LabelX, YPos, TEXT("Tracking:"), FLinearColor::White);
 	DrawShadowedText(ValueX, YPos, KeyName, FLinearColor(0.5f, 0.5f, 0.5f, 1.0f));
 	YPos += LineHeight;
 
+	// Sampling policy and measurement cost
+	DrawShadowedText(LabelX, YPos, TEXT("Sampling:"), FLinearColor::White);
+	DrawShadowedText(ValueX, YPos, FString::Printf(TEXT("%s  %.3f ms/frame"), *Sampler.GetModeName(), Sampler.GetLastFrameWorkSeconds() * 1000.0),
+		Sampler.IsSampling() ? FLinearColor::Yellow : FLinearColor(0.5f, 0.5f, 0.5f, 1.0f));
+	YPos += LineHeight;
+
+	// Lag by arrival phase (one value per tenth of the frame) and frame-quantization overhead
+	FString PhaseLine;
+	for (int32 Bin = 0; Bin < NumPhaseBins; ++Bin)
+	{
+		PhaseLine += (PhaseBinCounts[Bin] > 0) ? FString::Printf(TEXT("%.0f "), GetPhaseBinAverageLag(Bin)) : FString(TEXT("- "));
+	}
+	DrawShadowedText(LabelX, YPos, TEXT("Lag by Phase:"), FLinearColor::White);
+	DrawShadowedText(ValueX, YPos, PhaseLine, FLinearColor(0.7f, 0.7f, 0.7f, 1.0f));
+	YPos += LineHeight;
+
+	DrawShadowedText(LabelX, YPos, TEXT("Frame Wait:"), FLinearColor::White);
+	DrawShadowedText(ValueX, YPos, FString::Printf(TEXT("%5.2f ms (%.0f%% of lag)"), GetAverageQuantizationWait(), GetQuantizationShare() * 100.0f),
+		FLinearColor(0.7f, 0.7f, 0.7f, 1.0f));
+	YPos += LineHeight;
+
+	// Frames between input and measurement, flagged for a while after the detected depth changed
+	if (bShowPipelineDepth)
+	{
+		bool bRecentChange = PipelineDepth.GetChangeTime() > 0.0 && FPlatformTime::Seconds() - PipelineDepth.GetChangeTime() < PipelineDepthFlagSeconds;
+		FString DepthText = (PipelineDepth.GetDepth() > 0) ? FString::Printf(TEXT("depth %d"), PipelineDepth.GetDepth()) : FString(TEXT("depth ?"));
+		if (bRecentChange)
+		{
+			DepthText += FString::Printf(TEXT(" (was %d)"), PipelineDepth.GetPreviousDepth());
+		}
+		DrawShadowedText(LabelX, YPos, TEXT("Frames:"), FLinearColor::White);
+		DrawShadowedText(ValueX, YPos, DepthText + TEXT("  ") + PipelineDepth.GetHistogramText(),
+			bRecentChange ? FLinearColor::Red : FLinearColor(0.7f, 0.7f, 0.7f, 1.0f));
+		YPos += LineHeight;
+	}
+
+	// Where the slow samples spend their time (the average until a tail has built up)
+	if (bShowAttribution)
+	{
+		DrawShadowedText(LabelX, YPos, TEXT("Attribution:"), FLinearColor::White);
+		DrawShadowedText(ValueX, YPos, Attribution.HasTail() ? TEXT("p95 ") + Attribution.GetTail().Describe() : TEXT("avg ") + Attribution.GetAverage().Describe(),
+			FLinearColor(0.7f, 0.7f, 0.7f, 1.0f));
+		YPos += LineHeight;
+	}
+
+	// Mouse delivery: effective polling rate, interval jitter and raw events per frame
+	if (bShowPolling)
+	{
+		const FInputLagPollingStats& PollingStats = Polling.GetStats();
+		DrawShadowedText(LabelX, YPos, TEXT("Mouse:"), FLinearColor::White);
+		FString AxisText = (PollingStats.NumAxisCalls > 0)
+			? FString::Printf(TEXT("%.1f/InputAxis"), PollingStats.SamplesPerAxisCall)
+			: FString(TEXT("InputAxis n/a"));
+		DrawShadowedText(ValueX, YPos, FString::Printf(TEXT("%.0f Hz  jitter %.2f ms  %.1f/frame (max %d)  %s"),
+			PollingStats.EffectiveRateHz, PollingStats.JitterMs, PollingStats.EventsPerFrame, PollingStats.MaxEventsPerFrame, *AxisText),
+			FLinearColor(0.7f, 0.7f, 0.7f, 1.0f));
+		YPos += LineHeight;
+	}
+
+	// Click to server hit confirmation, split into its segments
+	if (bShowHitConfirm)
+	{
+		DrawShadowedText(LabelX, YPos, TEXT("Hit Confirm:"), FLinearColor::White);
+		DrawShadowedText(ValueX, YPos, FString::Printf(TEXT("p50 %.0f = %.0f local + %.0f net + %.0f server ms"),
+			HitConfirm.GetTotalPercentile(0.5f), HitConfirm.GetLocalPercentile(0.5f), HitConfirm.GetNetworkPercentile(0.5f), HitConfirm.GetServerPercentile(0.5f)),
+			FLinearColor(0.5f, 0.8f, 1.0f, 1.0f));
+		YPos += LineHeight;
+	}
+
+	// Fire click to the weapon's fire sound starting, next to the visual p95
+	if (bShowAudio)
+	{
+		DrawShadowedText(LabelX, YPos, TEXT("Audio:"), FLinearColor::White);
+		DrawShadowedText(ValueX, YPos, FString::Printf(TEXT("p50 %.0f  p95 %.0f ms  (visual p95 %.0f)"),
+			AudioLatency.GetPercentile(0.5f), AudioLatency.GetPercentile(0.95f), Get95thPercentileInputLag()),
+			FLinearColor(0.5f, 0.8f, 1.0f, 1.0f));
+		YPos += LineHeight;
+	}
+
+	// Input recording or replay progress
+	if (bShowRecording)
+	{
+		DrawShadowedText(LabelX, YPos, TEXT("Input:"), FLinearColor::White);
+		DrawShadowedText(ValueX, YPos, Recording.IsRecording() ? FString::Printf(TEXT("recording (%d events)"), Recording.GetEventCount())
+			: FString::Printf(TEXT("replaying %.0f%% of %d events"), Recording.GetReplayProgress() * 100.0f, Recording.GetEventCount()),
+			Recording.IsRecording() ? FLinearColor::Red : FLinearColor(0.5f, 0.8f, 1.0f, 1.0f));
+		YPos += LineHeight;
+	}
+
+	// Sweep progress
+	if (Sweep.IsRunning())
+	{
+		DrawShadowedText(LabelX, YPos, TEXT("Sweep:"), FLinearColor::White);
+		DrawShadowedText(ValueX, YPos, Sweep.GetStatusText(), FLinearColor(0.5f, 0.8f, 1.0f, 1.0f));
+		YPos += LineHeight;
+	}
+
+	// Frame pacing status and the lag change it achieved so far
+	if (bShowPacing)
+	{
+		DrawShadowedText(LabelX, YPos, TEXT("Pacing:"), FLinearColor::White);
+		DrawShadowedText(ValueX, YPos, FramePacer->GetStatusText(), FLinearColor(0.5f, 0.8f, 1.0f, 1.0f));
+		YPos += LineHeight;
+
+		FString Comparison = FramePacer->GetComparisonText();
+		DrawShadowedText(LabelX, YPos, TEXT("Pacing Gain:"), FLinearColor::White);
+		DrawShadowedText(ValueX, YPos, Comparison.IsEmpty() ? FString(TEXT("collecting samples...")) : Comparison,
+			FramePacer->HasComparison() && FramePacer->GetPacedPercentile(0.95f) <= FramePacer->GetBaselinePercentile(0.95f) ? FLinearColor::Green : FLinearColor::Yellow);
+		YPos += LineHeight;
+	}
+
+	// Late latching: mouse-look lag with and without it, from the same samples
+	if (bShowLateLatch)
+	{
+		FString LatchText = !LateLatch->IsCalibrated() ? FString(TEXT("calibrating (move the mouse)"))
+			: (UnlatchedLagSketch.GetTotalCount() == 0) ? FString::Printf(TEXT("ON (%.4f / %.4f deg per count)"), LateLatch->GetYawDegreesPerCount(), LateLatch->GetPitchDegreesPerCount())
+			: FString::Printf(TEXT("p50 %.1f ms vs %.1f ms unlatched (%+.1f ms)"), LatchedLagSketch.GetPercentile(0.5f), UnlatchedLagSketch.GetPercentile(0.5f),
+				LatchedLagSketch.GetPercentile(0.5f) - UnlatchedLagSketch.GetPercentile(0.5f));
+		DrawShadowedText(LabelX, YPos, TEXT("Late Latch:"), FLinearColor::White);
+		DrawShadowedText(ValueX, YPos, LatchText, LateLatch->IsCalibrated() ? FLinearColor::Green : FLinearColor::Yellow);
+		YPos += LineHeight;
+	}
+
 	// CSV logging status
 	if (bEnableCSVLogging)
 	{
 		DrawShadowedText(LabelX, YPos, TEXT("CSV Logging:"), FLinearColor::White);
-		DrawShadowedText(ValueX, YPos, FString::Printf(TEXT("ON (%d samples)"), CSVSampleCount), FLinearColor::Green);
+		DrawShadowedText(ValueX, YPos, FString::Printf(TEXT("ON (%d samples, %d files)"), CSVSampleCount, CSVWriter.GetFileCount()), FLinearColor::Green);
+		YPos += LineHeight;
+	}
+
+	// Trace export status
+	if (Trace.IsActive())
+	{
+		DrawShadowedText(LabelX, YPos, TEXT("Trace:"), FLinearColor::White);
+		DrawShadowedText(ValueX, YPos, FString::Printf(TEXT("ON (%d events)"), Trace.GetEventCount()), FLinearColor::Green);
+	}
+}
+
+void FInputLagDiagnostics::ToggleTrace()
+{
+	if (!FInputLagFeatures::bStageTiming)
+	{
+		if (PlayerOwner)
+		{
+			PlayerOwner->ClientMessage(TEXT("Input lag trace: not available in this build"));
+		}
+		return;
+	}
+
+	if (Trace.IsActive())
+	{
+		Trace.Stop();
+		if (PlayerOwner)
+		{
+			PlayerOwner->ClientMessage(FString::Printf(TEXT("Input lag trace stopped: %s"), *Trace.GetPath()));
+		}
+		return;
+	}
+
+	if (Trace.Start(Slot))
+	{
+		if (PlayerOwner)
+		{
+			PlayerOwner->ClientMessage(FString::Printf(TEXT("Input lag trace started: %s"), *Trace.GetPath()));
+		}
+	}
+	else if (PlayerOwner)
+	{
+		PlayerOwner->ClientMessage(TEXT("Failed to create trace file!"));
 	}
 }
 
 void FInputLagDiagnostics::ToggleCSVLogging()
 {
+	if (!FInputLagFeatures::bLogging)
+	{
+		if (PlayerOwner)
+		{
+			PlayerOwner->ClientMessage(TEXT("CSV logging: not available in this build"));
+		}
+		return;
+	}
+
 	bEnableCSVLogging = !bEnableCSVLogging;
 
 	if (bEnableCSVLogging)
 	{
-		// Create CSV file in Logs directory
+		// Create CSV file in Logs directory; every local player has its own file family
 		FString LogsDir = FPaths::GameSavedDir() + TEXT("Logs/");
 		FString Timestamp = FDateTime::Now().ToString(TEXT("%Y%m%d_%H%M%S"));
-		CSVFilePath = LogsDir + TEXT("InputLagLog_") + Timestamp + TEXT(".csv");
+		FString FilePrefix = FString::Printf(TEXT("InputLagLog_P%d_"), Slot + 1);
+		FString CSVFilePath = LogsDir + FilePrefix + Timestamp + TEXT(".csv");
+
+		// Compression, rotation and retention; the header row starts every rotated file
+		FInputLagLogWriterSettings Settings;
+		Settings.bCompress = true;
+		Settings.MaxFileBytes = 64 * 1024 * 1024;
+		Settings.MaxFileSeconds = 60.0 * 60.0;
+		Settings.MaxFiles = 20;
+		Settings.LoadFromConfig(TEXT("InputLagDiagnostics.Logging"));
 
-		// Create file
-		CSVFileHandle = FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*CSVFilePath);
+		// Retention only counts this player's files in the format being written
+		Settings.RetentionPattern = FilePrefix + (Settings.bCompress ? TEXT("*.csv.ilz") : TEXT("*.csv"));
+		Settings.FileHeader = ANSI_TO_TCHAR(InputLagCore::GetCsvHeader());
 
-		if (CSVFileHandle)
+		if (CSVWriter.Open(CSVFilePath, Settings))
 		{
-			// Write CSV header
-			FString Header = TEXT("Timestamp,FrameNumber,InputLag_ms,InputKey\n");
-			CSVFileHandle->Write((const uint8*)TCHAR_TO_ANSI(*Header), Header.Len());
 			CSVSampleCount = 0;
 
 			if (PlayerOwner)
 			{
-				PlayerOwner->ClientMessage(FString::Printf(TEXT("CSV logging started: %s"), *CSVFilePath));
+				PlayerOwner->ClientMessage(FString::Printf(TEXT("CSV logging started: %s"), *CSVWriter.GetPath()));
 			}
 		}
 		else
@@ -392,37 +1674,38 @@ void FInputLagDiagnostics::ToggleCSVLogging()
 	}
 	else
 	{
-		// Close CSV file
-		if (CSVFileHandle)
+		// Close CSV file (the writer thread flushes and writes the index footer)
+		if (CSVWriter.IsOpen())
 		{
-			delete CSVFileHandle;
-			CSVFileHandle = nullptr;
+			CSVWriter.Close();
 
 			if (PlayerOwner)
 			{
-				PlayerOwner->ClientMessage(FString::Printf(TEXT("CSV logging stopped. %d samples written to: %s"), CSVSampleCount, *CSVFilePath));
+				PlayerOwner->ClientMessage(FString::Printf(TEXT("CSV logging stopped. %d samples written to: %s (%d files)"),
+					CSVSampleCount, *CSVWriter.GetPath(), CSVWriter.GetFileCount()));
 			}
+
+			LogPhaseSummary();
 		}
 	}
 }
 
-void FInputLagDiagnostics::WriteCSVEntry(float InputLag)
+void FInputLagDiagnostics::WriteCSVEntry(const FInputLagRenderSample& Sample, uint64 LagFrames)
 {
-	if (!bEnableCSVLogging || !CSVFileHandle)
+	if (!FInputLagFeatures::bLogging || !bEnableCSVLogging || !CSVWriter.IsOpen())
 	{
 		return;
 	}
 
-	// Write CSV row: Timestamp, FrameNumber, InputLag_ms, InputKey
-	FString Timestamp = FDateTime::Now().ToString(TEXT("%Y-%m-%d %H:%M:%S.%s"));
-	FString Row = FString::Printf(TEXT("%s,%llu,%.3f,%s\n"), 
-		*Timestamp,
-		GFrameCounter,
-		InputLag,
-		*LastTrackedInputKey.ToString()
-	);
+	// Write CSV row in the core's format (the header row comes from the same place)
+	FString Timestamp = Sample.MeasuredAt.ToString(TEXT("%Y-%m-%d %H:%M:%S.%s"));
+	char Row[256];
+	if (InputLagCore::EncodeCsvRow(Row, sizeof(Row), TCHAR_TO_ANSI(*Timestamp), Sample.MeasuredFrame, Sample.LagMs,
+		TCHAR_TO_ANSI(*Sample.Key.ToString()), Sample.Phase, Sample.QuantizationWaitMs, LagFrames) < 0)
+	{
+		return;
+	}
+	CSVWriter.Write(FString(ANSI_TO_TCHAR(Row)));
 
-	CSVFileHandle->Write((const uint8*)TCHAR_TO_ANSI(*Row), Row.Len());
-	// Note: No Flush() in UE4 4.15 IFileHandle, data is written on delete
 	CSVSampleCount++;
 }
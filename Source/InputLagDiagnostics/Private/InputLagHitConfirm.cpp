@@ -0,0 +1,92 @@
+#include "InputLagDiagnostics.h"
+#include "InputLagHitConfirm.h"
+
+FInputLagHitConfirm::FInputLagHitConfirm()
+	: NextClick(0)
+	, NextTag(1)
+{
+	FMemory::Memzero(Clicks, sizeof(Clicks));
+}
+
+uint16 FInputLagHitConfirm::TagClick(double Now, uint64 Frame)
+{
+	// Mutator input component and player controller may both report the same press
+	const FClick& Last = Clicks[(NextClick + MaxPendingClicks - 1) % MaxPendingClicks];
+	if (Last.Tag != 0 && Last.Frame == Frame)
+	{
+		return 0;
+	}
+
+	FClick& Click = Clicks[NextClick];
+	NextClick = (NextClick + 1) % MaxPendingClicks;
+
+	Click.Tag = NextTag;
+	Click.Frame = Frame;
+	Click.ClickTime = Now;
+	Click.SentTime = 0.0;
+
+	NextTag = (NextTag == MAX_uint16) ? 1 : NextTag + 1;
+	return Click.Tag;
+}
+
+void FInputLagHitConfirm::BeginFrame(double FrameStart, uint64 Frame)
+{
+	for (int32 Index = 0; Index < MaxPendingClicks; ++Index)
+	{
+		FClick& Click = Clicks[Index];
+		if (Click.Tag != 0 && Click.SentTime == 0.0 && Click.Frame < Frame)
+		{
+			Click.SentTime = FrameStart;
+		}
+	}
+}
+
+bool FInputLagHitConfirm::Confirm(uint16 Tag, float ServerMs, double Now)
+{
+	FClick* Click = nullptr;
+	for (int32 Index = 0; Index < MaxPendingClicks; ++Index)
+	{
+		if (Clicks[Index].Tag == Tag && Tag != 0)
+		{
+			Click = &Clicks[Index];
+			break;
+		}
+	}
+
+	if (!Click)
+	{
+		return false;
+	}
+
+	// On a listen server host the hit is scored inside the click's own frame, before it ends
+	float TotalMs = (float)((Now - Click->ClickTime) * 1000.0);
+	float LocalMs = (Click->SentTime > 0.0) ? FMath::Min((float)((Click->SentTime - Click->ClickTime) * 1000.0), TotalMs) : TotalMs;
+	float ServerHeldMs = FMath::Clamp(ServerMs, 0.0f, TotalMs - LocalMs);
+	float NetworkMs = TotalMs - LocalMs - ServerHeldMs;
+
+	TotalSketch.Add(TotalMs);
+	LocalSketch.Add(LocalMs);
+	NetworkSketch.Add(NetworkMs);
+	ServerSketch.Add(ServerHeldMs);
+
+	// One confirmation per click
+	Click->Tag = 0;
+	return true;
+}
+
+void FInputLagHitConfirm::Reset()
+{
+	FMemory::Memzero(Clicks, sizeof(Clicks));
+	NextClick = 0;
+	TotalSketch.Reset();
+	LocalSketch.Reset();
+	NetworkSketch.Reset();
+	ServerSketch.Reset();
+}
+
+FString FInputLagHitConfirm::GetSummaryText(float Percentile) const
+{
+	return FString::Printf(TEXT("p%.0f %.1f ms: local %.1f / network %.1f / server %.1f, %llu hits"),
+		Percentile * 100.0f, GetTotalPercentile(Percentile), GetLocalPercentile(Percentile),
+		GetNetworkPercentile(Percentile), GetServerPercentile(Percentile), GetCount());
+}
@@ -0,0 +1,43 @@
+#include "InputLagDiagnostics.h"
+#include "InputLagInputProcessor.h"
+#include "InputLagHUD.h"
+
+FInputLagInputProcessor::FInputLagInputProcessor(FInputLagDiagnostics* InDiagnostics)
+	: Diagnostics(InDiagnostics)
+	, LastTickFrame(GFrameCounter)
+{
+}
+
+void FInputLagInputProcessor::Tick(const float DeltaTime, FSlateApplication& SlateApp, TSharedRef<ICursor> Cursor)
+{
+	// All work happens in the event handlers; the tick only shows Slate still has us installed
+	LastTickFrame = GFrameCounter;
+}
+
+bool FInputLagInputProcessor::HandleMouseMoveEvent(FSlateApplication& SlateApp, const FPointerEvent& MouseEvent)
+{
+	if (Diagnostics)
+	{
+		// Slate's cursor Y grows downwards, EKeys::MouseY grows upwards
+		FVector2D CursorDelta = MouseEvent.GetCursorDelta();
+		Diagnostics->OnRawMouseDelta(FVector2D(CursorDelta.X, -CursorDelta.Y));
+
+		// A replay measures recorded movement only; the player controller holds this event back
+		if (Diagnostics->Recording.IsReplaying())
+		{
+			return false;
+		}
+
+		if (CursorDelta.X != 0.0f)
+		{
+			Diagnostics->OnInputAxis(EKeys::MouseX, CursorDelta.X);
+		}
+		if (CursorDelta.Y != 0.0f)
+		{
+			Diagnostics->OnInputAxis(EKeys::MouseY, -CursorDelta.Y);
+		}
+	}
+
+	// Never consume - the game still needs the event
+	return false;
+}
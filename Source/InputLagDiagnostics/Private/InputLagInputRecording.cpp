@@ -0,0 +1,235 @@
+#include "InputLagDiagnostics.h"
+#include "InputLagInputRecording.h"
+
+FInputLagInputRecording::FInputLagInputRecording()
+	: bRecording(false)
+	, RecordingStartTime(0.0)
+	, RecordedEvents(0)
+	, bReplaying(false)
+	, ReplayStartTime(0.0)
+	, NextReplayEvent(0)
+{
+}
+
+void FInputLagInputRecording::StartRecording(const FString& InMapName)
+{
+	Buffer.Reset();
+	KeyIds.Reset();
+	RecordedEvents = 0;
+
+	FMemoryWriter Writer(Buffer);
+	uint32 Magic = FileMagic;
+	FString MapName = InMapName;
+	Writer << Magic << MapName;
+
+	RecordingStartTime = FPlatformTime::Seconds();
+	bRecording = true;
+}
+
+bool FInputLagInputRecording::StopRecording()
+{
+	if (!bRecording && Buffer.Num() == 0)
+	{
+		return false;
+	}
+	bRecording = false;
+
+	bool bWritten = false;
+	if (RecordedEvents > 0)
+	{
+		FString Timestamp = FDateTime::Now().ToString(TEXT("%Y%m%d_%H%M%S"));
+		Path = FPaths::GameSavedDir() + TEXT("Logs/InputLagInput_") + Timestamp + TEXT(".ilr");
+		bWritten = FFileHelper::SaveArrayToFile(Buffer, *Path);
+	}
+
+	Buffer.Empty();
+	KeyIds.Empty();
+	return bWritten;
+}
+
+bool FInputLagInputRecording::GetKeyId(const FKey& Key, uint8& OutId)
+{
+	if (const uint8* Id = KeyIds.Find(Key.GetFName()))
+	{
+		OutId = *Id;
+		return true;
+	}
+
+	if (KeyIds.Num() > MAX_uint8)
+	{
+		return false;
+	}
+
+	OutId = (uint8)KeyIds.Num();
+	KeyIds.Add(Key.GetFName(), OutId);
+
+	FMemoryWriter Writer(Buffer, false, true);
+	uint8 Kind = RecordKeyName;
+	FString KeyName = Key.ToString();
+	Writer << Kind << OutId << KeyName;
+	return true;
+}
+
+bool FInputLagInputRecording::GetRecordingOffset(double Now, uint32& OutMicroseconds)
+{
+	double Offset = Now - RecordingStartTime;
+	if (Offset >= MaxRecordingSeconds || Buffer.Num() >= MaxRecordingBytes)
+	{
+		StopRecording();
+		UE_LOG(LogTemp, Warning, TEXT("InputLag: Input recording reached its limit and was saved to %s"), *Path);
+		return false;
+	}
+
+	OutMicroseconds = (uint32)(FMath::Max(Offset, 0.0) * 1000000.0);
+	return true;
+}
+
+void FInputLagInputRecording::RecordKey(const FKey& Key, EInputEvent EventType, float AmountDepressed, bool bGamepad, double Now)
+{
+	uint32 Microseconds;
+	uint8 KeyId;
+	if (!bRecording || !GetRecordingOffset(Now, Microseconds) || !GetKeyId(Key, KeyId))
+	{
+		return;
+	}
+
+	FMemoryWriter Writer(Buffer, false, true);
+	uint8 Kind = RecordKeyEvent | (bGamepad ? RecordGamepadFlag : 0);
+	uint8 Event = (uint8)EventType;
+	Writer << Kind << Microseconds << KeyId << Event << AmountDepressed;
+	RecordedEvents++;
+}
+
+void FInputLagInputRecording::RecordAxis(const FKey& Key, float Delta, int32 NumSamples, bool bGamepad, double Now)
+{
+	uint32 Microseconds;
+	uint8 KeyId;
+	if (!bRecording || !GetRecordingOffset(Now, Microseconds) || !GetKeyId(Key, KeyId))
+	{
+		return;
+	}
+
+	FMemoryWriter Writer(Buffer, false, true);
+	uint8 Kind = RecordAxisEvent | (bGamepad ? RecordGamepadFlag : 0);
+	uint8 Samples = (uint8)FMath::Clamp(NumSamples, 0, (int32)MAX_uint8);
+	Writer << Kind << Microseconds << KeyId << Delta << Samples;
+	RecordedEvents++;
+}
+
+bool FInputLagInputRecording::LoadReplay(const FString& FileName)
+{
+	FString LoadPath = FPaths::IsRelative(FileName) ? FPaths::GameSavedDir() + TEXT("Logs/") + FileName : FileName;
+
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *LoadPath))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Data);
+	uint32 Magic = 0;
+	FString MapName;
+	Reader << Magic;
+	if (Magic != FileMagic)
+	{
+		return false;
+	}
+	Reader << MapName;
+
+	TArray<FKey> Keys;
+	TArray<FInputLagRecordedEvent> Events;
+	while (!Reader.AtEnd() && !Reader.IsError())
+	{
+		uint8 Kind = 0;
+		Reader << Kind;
+
+		if (Kind == RecordKeyName)
+		{
+			uint8 KeyId = 0;
+			FString KeyName;
+			Reader << KeyId << KeyName;
+			if (KeyId != Keys.Num())
+			{
+				return false;
+			}
+			Keys.Add(FKey(*KeyName));
+			continue;
+		}
+
+		uint32 Microseconds = 0;
+		uint8 KeyId = 0;
+		Reader << Microseconds << KeyId;
+		if (!Keys.IsValidIndex(KeyId))
+		{
+			return false;
+		}
+
+		FInputLagRecordedEvent Event;
+		Event.Time = Microseconds / 1000000.0;
+		Event.Key = Keys[KeyId];
+		Event.bGamepad = (Kind & RecordGamepadFlag) != 0;
+
+		if ((Kind & ~RecordGamepadFlag) == RecordKeyEvent)
+		{
+			uint8 EventType = 0;
+			Reader << EventType << Event.Value;
+			Event.bAxis = false;
+			Event.EventType = (EInputEvent)EventType;
+			Event.NumSamples = 0;
+		}
+		else if ((Kind & ~RecordGamepadFlag) == RecordAxisEvent)
+		{
+			uint8 Samples = 0;
+			Reader << Event.Value << Samples;
+			Event.bAxis = true;
+			Event.EventType = IE_Axis;
+			Event.NumSamples = Samples;
+		}
+		else
+		{
+			return false;
+		}
+
+		Events.Add(Event);
+	}
+
+	if (Reader.IsError() || Events.Num() == 0)
+	{
+		return false;
+	}
+
+	ReplayEvents = MoveTemp(Events);
+	ReplayMapName = MapName;
+	NextReplayEvent = 0;
+	bReplaying = false;
+	Path = LoadPath;
+	return true;
+}
+
+void FInputLagInputRecording::StartReplay(double Now)
+{
+	ReplayStartTime = Now;
+	NextReplayEvent = 0;
+	ReplaySketch.Reset();
+	bReplaying = ReplayEvents.Num() > 0;
+}
+
+void FInputLagInputRecording::StopReplay()
+{
+	bReplaying = false;
+}
+
+bool FInputLagInputRecording::PopDueEvent(double Now, FInputLagRecordedEvent& OutEvent)
+{
+	if (!bReplaying || ReplayEvents[NextReplayEvent].Time > Now - ReplayStartTime)
+	{
+		return false;
+	}
+
+	OutEvent = ReplayEvents[NextReplayEvent++];
+	if (NextReplayEvent >= ReplayEvents.Num())
+	{
+		bReplaying = false;
+	}
+	return true;
+}
@@ -0,0 +1,185 @@
+#include "InputLagDiagnostics.h"
+#include "InputLagLateLatch.h"
+
+namespace
+{
+	// Per-frame decay of the calibration sums, so sensitivity changes are picked up within seconds
+	const double CalibrationDecay = 0.98;
+
+	// Squared counts needed on an axis before its ratio is trusted
+	const double MinCalibrationSumXX = 2000.0;
+
+	// Frame-to-frame camera turns above this are respawns or teleports, not mouse look
+	const float MaxCalibrationDegrees = 30.0f;
+
+	// Latched pitch stays inside the range the camera allows
+	const float MaxLatchedPitch = 89.0f;
+}
+
+FInputLagLateLatch::FInputLagLateLatch()
+	: bEnabled(false)
+	, CountX(0.0)
+	, CountY(0.0)
+	, Sequence(0)
+	, bLookActive(false)
+	, LatchedViewActor(nullptr)
+	, CalibrationRotation(ForceInitToZero)
+	, CalibrationCountX(0.0)
+	, CalibrationCountY(0.0)
+	, bHasCalibrationBase(false)
+	, YawSumXY(0.0)
+	, YawSumXX(0.0)
+	, PitchSumXY(0.0)
+	, PitchSumXX(0.0)
+	, NextBase(0)
+	, NextRecord(0)
+{
+	FMemory::Memzero(Bases, sizeof(Bases));
+	FMemory::Memzero(Records, sizeof(Records));
+}
+
+void FInputLagLateLatch::SetEnabled(bool bInEnabled)
+{
+	FScopeLock ScopeLock(&Lock);
+	bEnabled = bInEnabled;
+
+	// Recalibrate from scratch each time, the player may have changed sensitivity in between
+	bHasCalibrationBase = false;
+	YawSumXY = YawSumXX = PitchSumXY = PitchSumXX = 0.0;
+}
+
+void FInputLagLateLatch::AddRawDelta(float DeltaX, float DeltaY)
+{
+	FScopeLock ScopeLock(&Lock);
+	CountX += DeltaX;
+	CountY += DeltaY;
+	Sequence++;
+}
+
+uint32 FInputLagLateLatch::GetSequence() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return Sequence;
+}
+
+void FInputLagLateLatch::UpdateCalibration(const FRotator& CameraRotation, const AActor* ViewActor, bool bInLookActive)
+{
+	FScopeLock ScopeLock(&Lock);
+	bLookActive = bInLookActive;
+	LatchedViewActor = ViewActor;
+
+	double DeltaX = CountX - CalibrationCountX;
+	double DeltaY = CountY - CalibrationCountY;
+	FRotator CameraDelta = (CameraRotation - CalibrationRotation).GetNormalized();
+
+	// Least squares through the origin: degrees = ratio * counts, fitted per axis
+	if (bHasCalibrationBase && bLookActive
+		&& FMath::Abs(CameraDelta.Yaw) < MaxCalibrationDegrees && FMath::Abs(CameraDelta.Pitch) < MaxCalibrationDegrees)
+	{
+		YawSumXY = YawSumXY * CalibrationDecay + CameraDelta.Yaw * DeltaX;
+		YawSumXX = YawSumXX * CalibrationDecay + DeltaX * DeltaX;
+
+		// Pitch stops at the clamp while the mouse keeps moving, so those frames are left out
+		if (FMath::Abs(FRotator::NormalizeAxis(CameraRotation.Pitch)) < MaxLatchedPitch - 1.0f)
+		{
+			PitchSumXY = PitchSumXY * CalibrationDecay + CameraDelta.Pitch * DeltaY;
+			PitchSumXX = PitchSumXX * CalibrationDecay + DeltaY * DeltaY;
+		}
+	}
+
+	CalibrationRotation = CameraRotation;
+	CalibrationCountX = CountX;
+	CalibrationCountY = CountY;
+	bHasCalibrationBase = true;
+}
+
+bool FInputLagLateLatch::IsCalibrated() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return YawSumXX >= MinCalibrationSumXX && PitchSumXX >= MinCalibrationSumXX;
+}
+
+float FInputLagLateLatch::GetYawDegreesPerCount() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return (YawSumXX >= MinCalibrationSumXX) ? (float)(YawSumXY / YawSumXX) : 0.0f;
+}
+
+float FInputLagLateLatch::GetPitchDegreesPerCount() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return (PitchSumXX >= MinCalibrationSumXX) ? (float)(PitchSumXY / PitchSumXX) : 0.0f;
+}
+
+bool FInputLagLateLatch::FindLatchTime(uint32 InSequence, double& OutTime) const
+{
+	FScopeLock ScopeLock(&Lock);
+
+	// Earliest latch whose new input range contains the sequence
+	bool bFound = false;
+	for (int32 Index = 0; Index < NumLatchRecords; ++Index)
+	{
+		const FLatchRecord& Record = Records[Index];
+		if (Record.Time > 0.0 && InSequence >= Record.FirstSequence && InSequence <= Record.LastSequence
+			&& (!bFound || Record.Time < OutTime))
+		{
+			OutTime = Record.Time;
+			bFound = true;
+		}
+	}
+	return bFound;
+}
+
+void FInputLagLateLatch::SetupView(FSceneViewFamily& InViewFamily, FSceneView& InView)
+{
+	FScopeLock ScopeLock(&Lock);
+
+	// The game thread built this view from everything pumped so far; remember that point
+	FLatchBase& Base = Bases[NextBase];
+	NextBase = (NextBase + 1) % NumLatchBases;
+
+	Base.FrameNumber = InViewFamily.FrameNumber;
+	Base.CountX = CountX;
+	Base.CountY = CountY;
+	Base.Sequence = Sequence;
+	Base.bApply = bEnabled && bLookActive && InView.ViewActor == LatchedViewActor
+		&& YawSumXX >= MinCalibrationSumXX && PitchSumXX >= MinCalibrationSumXX;
+}
+
+void FInputLagLateLatch::PreRenderView_RenderThread(FRHICommandListImmediate& RHICmdList, FSceneView& InView)
+{
+	float YawDegrees = 0.0f;
+	float PitchDegrees = 0.0f;
+	{
+		FScopeLock ScopeLock(&Lock);
+
+		const FLatchBase* Base = nullptr;
+		for (int32 Index = 0; Index < NumLatchBases; ++Index)
+		{
+			if (Bases[Index].FrameNumber == InView.Family->FrameNumber)
+			{
+				Base = &Bases[Index];
+				break;
+			}
+		}
+
+		if (!Base || !Base->bApply || !bEnabled || Sequence == Base->Sequence)
+		{
+			return;
+		}
+
+		// Everything pumped since the view was set up
+		YawDegrees = (float)((CountX - Base->CountX) * YawSumXY / YawSumXX);
+		PitchDegrees = (float)((CountY - Base->CountY) * PitchSumXY / PitchSumXX);
+
+		FLatchRecord& Record = Records[NextRecord];
+		NextRecord = (NextRecord + 1) % NumLatchRecords;
+		Record.FirstSequence = Base->Sequence + 1;
+		Record.LastSequence = Sequence;
+		Record.Time = FPlatformTime::Seconds();
+	}
+
+	InView.ViewRotation.Yaw += YawDegrees;
+	InView.ViewRotation.Pitch = FMath::Clamp(FRotator::NormalizeAxis(InView.ViewRotation.Pitch + PitchDegrees), -MaxLatchedPitch, MaxLatchedPitch);
+	InView.UpdateViewMatrix();
+}
@@ -0,0 +1,354 @@
+#include "InputLagDiagnostics.h"
+#include "InputLagLogWriter.h"
+#include "InputLagCore/InputLagCoreEncoding.h"
+
+namespace
+{
+	// Suffix of compressed files
+	const TCHAR* CompressedSuffix = TEXT(".ilz");
+
+	// Log file found by retention, with its last write time
+	struct FAgedFile
+	{
+		FDateTime Time;
+		FString Name;
+
+		// Oldest first; the name only breaks ties
+		bool operator<(const FAgedFile& Other) const
+		{
+			return Time != Other.Time ? Time < Other.Time : Name < Other.Name;
+		}
+	};
+}
+
+void FInputLagLogWriterSettings::LoadFromConfig(const TCHAR* Section)
+{
+	if (!GConfig)
+	{
+		return;
+	}
+
+	GConfig->GetBool(Section, TEXT("Compress"), bCompress, GGameIni);
+
+	int32 BlockSizeKB = BlockSize / 1024;
+	if (GConfig->GetInt(Section, TEXT("BlockSizeKB"), BlockSizeKB, GGameIni))
+	{
+		BlockSize = FMath::Max(BlockSizeKB, 1) * 1024;
+	}
+
+	float FlushSeconds = (float)BlockFlushSeconds;
+	if (GConfig->GetFloat(Section, TEXT("BlockFlushSeconds"), FlushSeconds, GGameIni))
+	{
+		BlockFlushSeconds = FMath::Max(FlushSeconds, 0.0f);
+	}
+
+	int32 MaxFileSizeMB = 0;
+	if (GConfig->GetInt(Section, TEXT("MaxFileSizeMB"), MaxFileSizeMB, GGameIni))
+	{
+		MaxFileBytes = (int64)FMath::Max(MaxFileSizeMB, 0) * 1024 * 1024;
+	}
+
+	float MaxFileMinutes = 0.0f;
+	if (GConfig->GetFloat(Section, TEXT("MaxFileMinutes"), MaxFileMinutes, GGameIni))
+	{
+		MaxFileSeconds = FMath::Max(MaxFileMinutes, 0.0f) * 60.0;
+	}
+
+	GConfig->GetInt(Section, TEXT("MaxFiles"), MaxFiles, GGameIni);
+}
+
+FInputLagLogWriter::FInputLagLogWriter()
+	: WakeEvent(nullptr)
+	, Thread(nullptr)
+	, FileHandle(nullptr)
+	, CurrentFileIndex(0)
+	, FileBytes(0)
+	, FileOpenTime(0.0)
+	, BlockFirstTime(0.0)
+	, BlockStartTime(0.0)
+	, UnixTimeAtOpen(0.0)
+	, SecondsAtOpen(0.0)
+{
+}
+
+FInputLagLogWriter::~FInputLagLogWriter()
+{
+	Close();
+}
+
+bool FInputLagLogWriter::Open(const FString& InPath, const FInputLagLogWriterSettings& InSettings)
+{
+	Close();
+
+	Path = InPath;
+	Settings = InSettings;
+	FilesCreated.Reset();
+	SecondsAtOpen = FPlatformTime::Seconds();
+	UnixTimeAtOpen = (FDateTime::UtcNow() - FDateTime(1970, 1, 1)).GetTotalSeconds();
+
+	// Pre-allocate block buffers once
+	BlockBuffer.Reset(Settings.bCompress ? Settings.BlockSize : 0);
+	BlockIndex.Reset();
+
+	// The first file is created here so the caller hears about failures; the thread owns it afterwards
+	if (!OpenFile(0))
+	{
+		return false;
+	}
+
+	StopRequested.Reset();
+	WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	Thread = FRunnableThread::Create(this, TEXT("InputLagLogWriter"), 0, TPri_BelowNormal);
+	if (!Thread)
+	{
+		// No threading available - fall back to closing immediately rather than writing on the game thread
+		FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+		WakeEvent = nullptr;
+		delete FileHandle;
+		FileHandle = nullptr;
+		return false;
+	}
+
+	return true;
+}
+
+void FInputLagLogWriter::Close()
+{
+	if (!Thread)
+	{
+		return;
+	}
+
+	// The writer thread drains whatever is still queued and finishes the file before it exits
+	StopRequested.Set(1);
+	WakeEvent->Trigger();
+	Thread->WaitForCompletion();
+	delete Thread;
+	Thread = nullptr;
+
+	FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+	WakeEvent = nullptr;
+}
+
+void FInputLagLogWriter::Write(FString&& Text)
+{
+	if (Thread)
+	{
+		FQueuedText Item;
+		Item.Text = MoveTemp(Text);
+		Item.Time = FPlatformTime::Seconds();
+		PendingText.Enqueue(MoveTemp(Item));
+	}
+}
+
+void FInputLagLogWriter::Write(const FString& Text)
+{
+	Write(FString(Text));
+}
+
+uint32 FInputLagLogWriter::Run()
+{
+	// No per-write wakeups: the game thread never pays for a syscall, the writer just polls
+	while (StopRequested.GetValue() == 0)
+	{
+		WakeEvent->Wait(FlushIntervalMs);
+		Drain();
+	}
+
+	Drain();
+	FinishFile();
+	return 0;
+}
+
+void FInputLagLogWriter::Stop()
+{
+	StopRequested.Set(1);
+	if (WakeEvent)
+	{
+		WakeEvent->Trigger();
+	}
+}
+
+void FInputLagLogWriter::Drain()
+{
+	FQueuedText Item;
+	while (PendingText.Dequeue(Item))
+	{
+		AppendText(Item.Text, Item.Time);
+	}
+
+	// Don't let a quiet log sit in memory indefinitely
+	if (BlockBuffer.Num() > 0 && FPlatformTime::Seconds() - BlockStartTime >= Settings.BlockFlushSeconds)
+	{
+		FlushBlock();
+	}
+}
+
+void FInputLagLogWriter::AppendText(const FString& Text, double Time)
+{
+	bool bFileFull = Settings.MaxFileBytes > 0 && FileBytes >= Settings.MaxFileBytes;
+	bool bFileOld = Settings.MaxFileSeconds > 0.0 && Time - FileOpenTime >= Settings.MaxFileSeconds;
+	if (bFileFull || bFileOld)
+	{
+		FinishFile();
+		OpenFile(CurrentFileIndex + 1);
+	}
+
+	if (!FileHandle)
+	{
+		return;
+	}
+
+	FTCHARToUTF8 Converter(*Text);
+	if (!Settings.bCompress)
+	{
+		WriteBytes((const uint8*)Converter.Get(), Converter.Length());
+		return;
+	}
+
+	if (BlockBuffer.Num() == 0)
+	{
+		BlockFirstTime = Time;
+		BlockStartTime = FPlatformTime::Seconds();
+	}
+	BlockBuffer.Append((const uint8*)Converter.Get(), Converter.Length());
+
+	if (BlockBuffer.Num() >= Settings.BlockSize)
+	{
+		FlushBlock();
+	}
+}
+
+void FInputLagLogWriter::FlushBlock()
+{
+	if (!FileHandle || BlockBuffer.Num() == 0)
+	{
+		return;
+	}
+
+	int32 UncompressedSize = BlockBuffer.Num();
+	int32 CompressedSize = FCompression::CompressMemoryBound(COMPRESS_ZLIB, UncompressedSize);
+	CompressedBuffer.SetNumUninitialized(CompressedSize, false);
+
+	const uint8* Payload = CompressedBuffer.GetData();
+	if (!FCompression::CompressMemory(COMPRESS_ZLIB, CompressedBuffer.GetData(), CompressedSize, BlockBuffer.GetData(), UncompressedSize)
+		|| CompressedSize >= UncompressedSize)
+	{
+		// Incompressible (or compression failed) - store the block as is
+		Payload = BlockBuffer.GetData();
+		CompressedSize = UncompressedSize;
+	}
+
+	FBlockIndexEntry Entry;
+	Entry.Offset = FileBytes;
+	Entry.FirstTimestamp = UnixTimeAtOpen + (BlockFirstTime - SecondsAtOpen);
+	Entry.UncompressedSize = (uint32)UncompressedSize;
+	Entry.CompressedSize = (uint32)CompressedSize;
+	BlockIndex.Add(Entry);
+
+	uint8 Header[InputLagCore::LogBlockHeaderSize];
+	WriteBytes(Header, InputLagCore::EncodeLogBlockHeader(Header, Entry.UncompressedSize, Entry.CompressedSize));
+	WriteBytes(Payload, CompressedSize);
+
+	BlockBuffer.Reset();
+}
+
+bool FInputLagLogWriter::OpenFile(int32 FileIndex)
+{
+	CurrentFileIndex = FileIndex;
+	FileBytes = 0;
+	FileOpenTime = FPlatformTime::Seconds();
+	BlockIndex.Reset();
+
+	FileHandle = FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*GetFilePath(FileIndex));
+	if (!FileHandle)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("InputLag: Failed to create log file %s"), *GetFilePath(FileIndex));
+		return false;
+	}
+
+	FilesCreated.Increment();
+	PruneOldFiles();
+
+	if (!Settings.FileHeader.IsEmpty())
+	{
+		AppendText(Settings.FileHeader, FileOpenTime);
+	}
+	return true;
+}
+
+void FInputLagLogWriter::FinishFile()
+{
+	if (!FileHandle)
+	{
+		return;
+	}
+
+	if (Settings.bCompress)
+	{
+		FlushBlock();
+
+		TArray<uint8> Footer;
+		Footer.AddUninitialized(BlockIndex.Num() * InputLagCore::LogIndexEntrySize + InputLagCore::LogTrailerSize);
+
+		int32 FooterSize = 0;
+		for (const FBlockIndexEntry& Entry : BlockIndex)
+		{
+			FooterSize += InputLagCore::EncodeLogIndexEntry(Footer.GetData() + FooterSize, Entry.Offset, Entry.FirstTimestamp, Entry.UncompressedSize, Entry.CompressedSize);
+		}
+		FooterSize += InputLagCore::EncodeLogTrailer(Footer.GetData() + FooterSize, (uint32)BlockIndex.Num(), FileBytes);
+		WriteBytes(Footer.GetData(), FooterSize);
+	}
+
+	// Note: No Flush() in UE4 4.15 IFileHandle, data is written on delete
+	delete FileHandle;
+	FileHandle = nullptr;
+}
+
+void FInputLagLogWriter::PruneOldFiles()
+{
+	if (Settings.MaxFiles <= 0 || Settings.RetentionPattern.IsEmpty())
+	{
+		return;
+	}
+
+	// Oldest first by modification time: name order breaks once a rotation index outgrows its
+	// padding (_1000 sorts before _999), so names only break ties
+	FString Directory = FPaths::GetPath(Path);
+	TArray<FString> Files;
+	IFileManager::Get().FindFiles(Files, *(Directory / Settings.RetentionPattern), true, false);
+
+	TArray<FAgedFile> AgedFiles;
+	AgedFiles.Reserve(Files.Num());
+	for (const FString& File : Files)
+	{
+		FAgedFile& AgedFile = AgedFiles[AgedFiles.AddDefaulted()];
+		AgedFile.Time = IFileManager::Get().GetTimeStamp(*(Directory / File));
+		AgedFile.Name = File;
+	}
+	AgedFiles.Sort();
+
+	for (int32 Index = 0; Index < AgedFiles.Num() - Settings.MaxFiles; ++Index)
+	{
+		IFileManager::Get().Delete(*(Directory / AgedFiles[Index].Name));
+	}
+}
+
+void FInputLagLogWriter::WriteBytes(const uint8* Data, int64 Size)
+{
+	if (FileHandle && Size > 0)
+	{
+		FileHandle->Write(Data, Size);
+		FileBytes += Size;
+	}
+}
+
+FString FInputLagLogWriter::GetFilePath(int32 FileIndex) const
+{
+	FString FilePath = Path;
+	if (FileIndex > 0)
+	{
+		FilePath = FPaths::GetBaseFilename(Path, false) + FString::Printf(TEXT("_%03d"), FileIndex) + FPaths::GetExtension(Path, true);
+	}
+	return Settings.bCompress ? FilePath + CompressedSuffix : FilePath;
+}
@@ -0,0 +1,115 @@
+#include "InputLagDiagnostics.h"
+#include "InputLagMeasurementService.h"
+
+FInputLagMeasurementService::FInputLagMeasurementService()
+	: LateLatch(MakeShareable(new FInputLagLateLatch()))
+{
+	FMemory::Memzero(AttachCounts, sizeof(AttachCounts));
+
+	for (int32 Slot = 0; Slot < MaxSessions; ++Slot)
+	{
+		Sessions[Slot].BindPlayerSlot(&Players, Slot);
+		Sessions[Slot].FramePacer = &FramePacer;
+	}
+
+	// Raw mouse movement only reaches the primary player (Slate has a single mouse)
+	Sessions[0].LateLatch = LateLatch;
+
+	// Frame boundary timestamps for input phase analysis, shared by every player
+	FCoreDelegates::OnBeginFrame.AddRaw(this, &FInputLagMeasurementService::OnBeginFrame);
+	FCoreDelegates::OnEndFrame.AddRaw(this, &FInputLagMeasurementService::OnEndFrame);
+}
+
+FInputLagMeasurementService::~FInputLagMeasurementService()
+{
+	// Hand the frame rate limit back to the engine
+	FramePacer.Disable();
+
+	// Stop the renderer calling into the late latch
+	if (GEngine)
+	{
+		GEngine->ViewExtensions.Remove(LateLatch);
+	}
+
+	FCoreDelegates::OnBeginFrame.RemoveAll(this);
+	FCoreDelegates::OnEndFrame.RemoveAll(this);
+}
+
+void FInputLagMeasurementService::OnBeginFrame()
+{
+	// Pacing sleeps before the frame is stamped, so phase analysis sees the frame as the input does
+	FramePacer.OnBeginFrame();
+	Players.BeginFrame(FPlatformTime::Seconds());
+}
+
+void FInputLagMeasurementService::OnEndFrame()
+{
+	double Now = FPlatformTime::Seconds();
+	Players.EndFrame(Now);
+	FramePacer.OnEndFrame();
+
+	// Frame slices for sessions exporting a trace
+	for (int32 Slot = 0; Slot < MaxSessions; ++Slot)
+	{
+		if (Sessions[Slot].Trace.IsActive())
+		{
+			Sessions[Slot].Trace.AddFrame(GFrameCounter, Players.CurrentFrameStart, Now);
+		}
+	}
+}
+
+FInputLagSessionHandle FInputLagMeasurementService::Attach(int32 Slot)
+{
+	if (Slot < 0 || Slot >= MaxSessions)
+	{
+		return FInputLagSessionHandle();
+	}
+
+	AttachCounts[Slot]++;
+	return FInputLagSessionHandle(Slot);
+}
+
+void FInputLagMeasurementService::Detach(FInputLagSessionHandle& Handle, APlayerController* Owner)
+{
+	FInputLagDiagnostics* Session = Resolve(Handle);
+	if (!Session)
+	{
+		return;
+	}
+
+	AttachCounts[Handle.Slot] = FMath::Max(AttachCounts[Handle.Slot] - 1, 0);
+
+	// The controller is about to go away with its world - never keep a dangling owner. Once the
+	// last handle is gone nobody can clear the owner later, so the slot is released whoever set it
+	if ((Owner && Session->PlayerOwner == Owner) || AttachCounts[Handle.Slot] == 0)
+	{
+		Session->PlayerOwner = nullptr;
+		Session->ResetPendingMeasurement();
+	}
+
+	Handle = FInputLagSessionHandle();
+}
+
+FInputLagDiagnostics* FInputLagMeasurementService::Resolve(const FInputLagSessionHandle& Handle)
+{
+	return Handle.IsValid() ? &Sessions[Handle.Slot] : nullptr;
+}
+
+int32 FInputLagMeasurementService::GetLocalPlayerSlot(APlayerController* PC)
+{
+	// On a listen server a remote client's controller has a net connection as its player
+	ULocalPlayer* LocalPlayer = PC ? Cast<ULocalPlayer>(PC->Player) : nullptr;
+	if (!LocalPlayer || !PC->IsLocalController())
+	{
+		return INDEX_NONE;
+	}
+
+	UGameInstance* GameInstance = PC->GetGameInstance();
+	if (!GameInstance)
+	{
+		return 0;
+	}
+
+	int32 Index = GameInstance->GetLocalPlayers().Find(LocalPlayer);
+	return FMath::Clamp(Index, 0, MaxSessions - 1);
+}
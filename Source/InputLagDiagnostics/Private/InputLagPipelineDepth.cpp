@@ -0,0 +1,155 @@
+#include "InputLagDiagnostics.h"
+#include "InputLagPipelineDepth.h"
+
+namespace
+{
+	// Render command parameter (the command macros do not take template arguments with commas)
+	typedef TSharedRef<FInputLagRenderStampSlots, ESPMode::ThreadSafe> FRenderStampSlotsRef;
+}
+
+FInputLagPipelineDepth::FInputLagPipelineDepth()
+{
+	Reset();
+}
+
+bool FInputLagPipelineDepth::AddSample(uint64 Frames, double Now)
+{
+	uint8 Bucket = (uint8)FMath::Clamp<uint64>(Frames, 1, MaxFrames);
+	Counts[Bucket]++;
+	TotalCount++;
+
+	// Replace the oldest window entry once the window is full
+	if (WindowFill == WindowSize)
+	{
+		WindowCounts[Window[WindowIndex]]--;
+	}
+	else
+	{
+		WindowFill++;
+	}
+	Window[WindowIndex] = Bucket;
+	WindowCounts[Bucket]++;
+	WindowIndex = (WindowIndex + 1) % WindowSize;
+
+	if (WindowFill < WindowSize)
+	{
+		return false;
+	}
+
+	int32 Mode = 1;
+	for (int32 Index = 2; Index <= MaxFrames; ++Index)
+	{
+		if (WindowCounts[Index] > WindowCounts[Mode])
+		{
+			Mode = Index;
+		}
+	}
+
+	// A new depth has to hold half the window, so a few odd frames do not flip it back and forth
+	if (Mode == Depth || WindowCounts[Mode] * 2 < WindowSize)
+	{
+		return false;
+	}
+
+	bool bChanged = (Depth != 0);
+	PreviousDepth = Depth;
+	Depth = Mode;
+	if (bChanged)
+	{
+		ChangeTime = Now;
+	}
+	return bChanged;
+}
+
+void FInputLagPipelineDepth::Reset()
+{
+	FMemory::Memzero(Counts, sizeof(Counts));
+	TotalCount = 0;
+	FMemory::Memzero(Window, sizeof(Window));
+	WindowIndex = 0;
+	WindowFill = 0;
+	FMemory::Memzero(WindowCounts, sizeof(WindowCounts));
+	Depth = 0;
+	PreviousDepth = 0;
+	ChangeTime = 0.0;
+}
+
+FString FInputLagPipelineDepth::GetHistogramText() const
+{
+	FString Text;
+	for (int32 Index = 1; Index <= MaxFrames && TotalCount > 0; ++Index)
+	{
+		float Share = (float)Counts[Index] / TotalCount;
+		if (Share >= 0.01f)
+		{
+			Text += FString::Printf(TEXT("%s%d%s:%.0f%%"), Text.IsEmpty() ? TEXT("") : TEXT(" "),
+				Index, Index == MaxFrames ? TEXT("+") : TEXT(""), Share * 100.0f);
+		}
+	}
+	return Text;
+}
+
+FInputLagRenderStamps::FInputLagRenderStamps()
+	: Slots(MakeShareable(new FInputLagRenderStampSlots()))
+	, NextSequence(0)
+{
+	FMemory::Memzero(Frames, sizeof(Frames));
+	FMemory::Memzero(FrameStarts, sizeof(FrameStarts));
+}
+
+uint32 FInputLagRenderStamps::Stamp()
+{
+	NextSequence++;
+	if (NextSequence == 0)
+	{
+		NextSequence++;
+	}
+
+	// Commands run in order, so an older stamp never overwrites a slot a newer one reuses
+	ENQUEUE_UNIQUE_RENDER_COMMAND_TWOPARAMETER(
+		InputLagRenderStamp,
+		FRenderStampSlotsRef, StampSlots, Slots,
+		uint32, StampSequence, NextSequence,
+	{
+		int32 Index = StampSequence % FInputLagRenderStampSlots::NumSlots;
+		StampSlots->Time[Index] = FPlatformTime::Seconds();
+		FPlatformAtomics::InterlockedExchange(&StampSlots->Sequence[Index], (int32)StampSequence);
+	});
+	return NextSequence;
+}
+
+bool FInputLagRenderStamps::GetTime(uint32 Sequence, double& OutTime) const
+{
+	int32 Index = Sequence % Capacity;
+	if ((uint32)Slots->Sequence[Index] != Sequence)
+	{
+		return false;
+	}
+
+	// The time was written before the sequence was published
+	FPlatformMisc::MemoryBarrier();
+	OutTime = Slots->Time[Index];
+	return true;
+}
+
+void FInputLagRenderStamps::AddFrameStart(uint64 Frame, double StartTime)
+{
+	int32 Index = (int32)(Frame % Capacity);
+	Frames[Index] = Frame;
+	FrameStarts[Index] = StartTime;
+}
+
+bool FInputLagRenderStamps::FindFrame(double Time, uint64& OutFrame, double& OutStartTime) const
+{
+	bool bFound = false;
+	for (int32 Index = 0; Index < Capacity; ++Index)
+	{
+		if (FrameStarts[Index] > 0.0 && FrameStarts[Index] <= Time && (!bFound || Frames[Index] > OutFrame))
+		{
+			OutFrame = Frames[Index];
+			OutStartTime = FrameStarts[Index];
+			bFound = true;
+		}
+	}
+	return bFound;
+}
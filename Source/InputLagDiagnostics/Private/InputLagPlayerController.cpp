@@ -3,247 +3,294 @@
 
 AInputLagPlayerController::AInputLagPlayerController(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
+	, bShowInputLagDiagnostics(false)
+	, CachedSession(nullptr)
+	, bInjectingReplay(false)
+	, bMirroredShowInputLag(false)
+	, bWarnedRecordInputExecution(false)
 {
-	bShowInputLagDiagnostics = false;
-	LastInputTimestamp = 0.0;
-	InputFrameNumber = 0;
-	LastTrackedInputKey = EKeys::Invalid;
-	bPendingInputMeasurement = false;
-	HistoryIndex = 0;
-	SmoothedInputLag = 0.0f;
-	RawInputLag = 0.0f;
-	
-	// Pre-allocate circular buffer
-	InputLagHistory.AddZeroed(MaxInputLagSamples);
 }
 
-void AInputLagPlayerController::ShowInputLag()
+FInputLagDiagnostics* AInputLagPlayerController::GetSession() const
+{
+	return CachedSession;
+}
+
+void AInputLagPlayerController::BeginPlay()
 {
-	bShowInputLagDiagnostics = !bShowInputLagDiagnostics;
-	if (bShowInputLagDiagnostics)
+	Super::BeginPlay();
+
+	// Only the local player's controller measures; its session survives map travel
+	FInputLagMeasurementService* Service = FInputLagDiagnosticsModule::Get().GetService();
+	if (Service && IsLocalPlayerController())
 	{
-		ClientMessage(TEXT("Input Lag Diagnostics: ON"));
+		SessionHandle = Service->Attach(FInputLagMeasurementService::GetLocalPlayerSlot(this));
+
+		// Sessions never move, so the input overrides use the pointer instead of a module lookup per event
+		CachedSession = Service->Resolve(SessionHandle);
+		if (CachedSession)
+		{
+			CachedSession->PlayerOwner = this;
+			bShowInputLagDiagnostics = bMirroredShowInputLag = CachedSession->bShowInputLagDiagnostics;
+
+			// -InputLagReplay=<file> replays on the first map this controller plays
+			CachedSession->StartCommandLineReplay();
+		}
 	}
-	else
+}
+
+void AInputLagPlayerController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	FInputLagMeasurementService* Service = FInputLagDiagnosticsModule::Get().GetService();
+	if (Service)
 	{
-		ClientMessage(TEXT("Input Lag Diagnostics: OFF"));
+		Service->Detach(SessionHandle, this);
 	}
+	CachedSession = nullptr;
+
+	Super::EndPlay(EndPlayReason);
 }
 
-void AInputLagPlayerController::RecordInputTimestamp(FKey Key)
+void AInputLagPlayerController::ShowInputLag()
 {
-	if (!bShowInputLagDiagnostics)
+	if (FInputLagDiagnostics* Session = GetSession())
 	{
-		return;
+		Session->ShowInputLag();
 	}
+}
 
-	// Only record new input if we're not already waiting for measurement
-	if (!bPendingInputMeasurement)
+void AInputLagPlayerController::VerifyInputLag()
+{
+	if (FInputLagDiagnostics* Session = GetSession())
 	{
-		// Record the timestamp when input arrives from Windows
-		LastInputTimestamp = FPlatformTime::Seconds();
-		InputFrameNumber = GFrameCounter;
-		LastTrackedInputKey = Key;
-		bPendingInputMeasurement = true;
+		Session->ToggleVerifiedCameraLag();
 	}
 }
 
-void AInputLagPlayerController::RecordInputExecution(FKey Key)
+void AInputLagPlayerController::InputLagSampling(const FString& ModeName, const FString& Param)
 {
-	if (!bShowInputLagDiagnostics || LastInputTimestamp == 0.0)
+	if (FInputLagDiagnostics* Session = GetSession())
 	{
-		return;
+		Session->SetSamplingMode(ModeName, Param);
 	}
+}
 
-	// Only record if this execution matches the last tracked input
-	if (Key == LastTrackedInputKey)
+void AInputLagPlayerController::InputLagTrace()
+{
+	if (FInputLagDiagnostics* Session = GetSession())
 	{
-		double ExecutionTime = FPlatformTime::Seconds();
-		float InputLagMs = (ExecutionTime - LastInputTimestamp) * 1000.0f;
-
-		// Add to history
-		if (InputLagHistory.Num() >= MaxInputLagSamples)
-		{
-			InputLagHistory.RemoveAt(0);
-		}
-		InputLagHistory.Add(InputLagMs);
-
-		// Reset for next input
-		LastInputTimestamp = 0.0;
+		Session->ToggleTrace();
 	}
 }
 
-float AInputLagPlayerController::GetAverageInputLag() const
+void AInputLagPlayerController::InputLagRecord()
 {
-	float Sum = 0.0f;
-	int32 ValidSamples = 0;
-	
-	for (float Lag : InputLagHistory)
+	if (FInputLagDiagnostics* Session = GetSession())
 	{
-		if (Lag > 0.0f) // Only count valid samples (buffer may not be full yet)
-		{
-			Sum += Lag;
-			ValidSamples++;
-		}
+		Session->ToggleInputRecording();
 	}
-	
-	return (ValidSamples > 0) ? (Sum / ValidSamples) : 0.0f;
 }
 
-float AInputLagPlayerController::GetLastInputLag() const
+void AInputLagPlayerController::InputLagReplay(const FString& FileName)
 {
-	// Get the most recent sample (before current index)
-	int32 LastIndex = (HistoryIndex - 1 + MaxInputLagSamples) % MaxInputLagSamples;
-	return InputLagHistory[LastIndex];
+	if (FInputLagDiagnostics* Session = GetSession())
+	{
+		Session->StartInputReplay(FileName);
+	}
 }
 
-float AInputLagPlayerController::GetMinInputLag() const
+void AInputLagPlayerController::ReplayInput(float DeltaTime)
 {
-	float MinLag = FLT_MAX;
-	bool bFoundValid = false;
-	
-	for (float Lag : InputLagHistory)
+	bInjectingReplay = true;
+
+	FInputLagRecordedEvent Event;
+	while (CachedSession && CachedSession->PopReplayEvent(Event))
 	{
-		if (Lag > 0.0f) // Only consider valid samples
+		if (Event.bAxis)
 		{
-			MinLag = FMath::Min(MinLag, Lag);
-			bFoundValid = true;
+			InputAxis(Event.Key, Event.Value, DeltaTime, Event.NumSamples, Event.bGamepad);
+		}
+		else
+		{
+			InputKey(Event.Key, Event.EventType, Event.Value, Event.bGamepad);
 		}
 	}
-	
-	return bFoundValid ? MinLag : 0.0f;
+
+	bInjectingReplay = false;
 }
 
-float AInputLagPlayerController::GetMaxInputLag() const
+void AInputLagPlayerController::RecordInputTimestamp(FKey Key, float AxisDelta)
 {
-	float MaxLag = 0.0f;
-	
-	for (float Lag : InputLagHistory)
+	FInputLagDiagnostics* Session = GetSession();
+	if (!Session)
 	{
-		if (Lag > 0.0f) // Only consider valid samples
-		{
-			MaxLag = FMath::Max(MaxLag, Lag);
-		}
+		return;
+	}
+
+	// The session applies the enable flag, sampling policy and one-measurement-at-a-time rule
+	if (Key == EKeys::MouseX || Key == EKeys::MouseY)
+	{
+		// Verified mode compares the camera turn against this delta, so it has to be the real movement
+		Session->OnInputAxis(Key, AxisDelta != 0.0f ? AxisDelta : GetInputAnalogKeyState(Key));
+	}
+	else
+	{
+		Session->OnInputKey(Key, IE_Pressed);
 	}
-	
-	return MaxLag;
 }
 
-float AInputLagPlayerController::Get95thPercentileInputLag() const
+void AInputLagPlayerController::RecordInputExecution(FKey Key)
 {
-	// Collect valid samples
-	TArray<float> ValidSamples;
-	ValidSamples.Reserve(MaxInputLagSamples);
-	
-	for (float Lag : InputLagHistory)
+	FInputLagDiagnostics* Session = GetSession();
+	if (!Session || !Session->Players)
 	{
-		if (Lag > 0.0f)
-		{
-			ValidSamples.Add(Lag);
-		}
+		return;
 	}
-	
-	if (ValidSamples.Num() == 0)
+
+	if (!bWarnedRecordInputExecution)
 	{
-		return 0.0f;
+		bWarnedRecordInputExecution = true;
+		UE_LOG(LogTemp, Warning, TEXT("InputLag: RecordInputExecution is deprecated; measurements close on the next drawn frame"));
+	}
+
+	// Only close the measurement this execution belongs to
+	int32 Slot = Session->GetPlayerSlot();
+	if (Session->Players->PendingMeasurement[Slot] && Session->Players->TrackedKey[Slot] == Key)
+	{
+		Session->FinalizeInputLagMeasurement();
 	}
-	
-	// Sort samples
-	ValidSamples.Sort();
-	
-	// Get 95th percentile (95% of samples are below this value)
-	int32 Index = FMath::CeilToInt(ValidSamples.Num() * 0.95f) - 1;
-	Index = FMath::Clamp(Index, 0, ValidSamples.Num() - 1);
-	
-	return ValidSamples[Index];
+}
+
+float AInputLagPlayerController::GetAverageInputLag() const
+{
+	FInputLagDiagnostics* Session = GetSession();
+	return Session ? Session->GetAverageInputLag() : 0.0f;
+}
+
+float AInputLagPlayerController::GetLastInputLag() const
+{
+	FInputLagDiagnostics* Session = GetSession();
+	return Session ? Session->GetLastInputLag() : 0.0f;
+}
+
+float AInputLagPlayerController::GetMinInputLag() const
+{
+	FInputLagDiagnostics* Session = GetSession();
+	return Session ? Session->GetMinInputLag() : 0.0f;
+}
+
+float AInputLagPlayerController::GetMaxInputLag() const
+{
+	FInputLagDiagnostics* Session = GetSession();
+	return Session ? Session->GetMaxInputLag() : 0.0f;
+}
+
+float AInputLagPlayerController::Get95thPercentileInputLag() const
+{
+	FInputLagDiagnostics* Session = GetSession();
+	return Session ? Session->Get95thPercentileInputLag() : 0.0f;
 }
 
 float AInputLagPlayerController::GetSmoothedInputLag() const
 {
-	return SmoothedInputLag;
+	FInputLagDiagnostics* Session = GetSession();
+	return Session ? Session->GetSmoothedInputLag() : 0.0f;
 }
 
 float AInputLagPlayerController::GetRawInputLag() const
 {
-	return RawInputLag;
+	FInputLagDiagnostics* Session = GetSession();
+	return Session ? Session->GetRawInputLag() : 0.0f;
 }
 
-bool AInputLagPlayerController::InputKey(FKey Key, EInputEvent EventType, float AmountDepressed, bool bGamepad)
+void AInputLagPlayerController::PlayerTick(float DeltaTime)
 {
-	// Record timestamp for mouse button presses
-	if (bShowInputLagDiagnostics && (EventType == IE_Pressed || EventType == IE_Repeat))
+	if (CachedSession)
 	{
-		if (Key == EKeys::LeftMouseButton || Key == EKeys::RightMouseButton)
+		// A Blueprint write to the deprecated mirror toggles the session; otherwise the mirror follows it
+		if (bShowInputLagDiagnostics != bMirroredShowInputLag)
 		{
-			RecordInputTimestamp(Key);
+			CachedSession->SetEnabled(bShowInputLagDiagnostics);
 		}
+		bShowInputLagDiagnostics = bMirroredShowInputLag = CachedSession->bShowInputLagDiagnostics;
 	}
 
-	return Super::InputKey(Key, EventType, AmountDepressed, bGamepad);
-}
-
-bool AInputLagPlayerController::InputAxis(FKey Key, float Delta, float DeltaTime, int32 NumSamples, bool bGamepad)
-{
-	// Record timestamp for mouse movement
-	if (bShowInputLagDiagnostics)
+	// Close the previous frame's measurement budget before this frame's input is processed
+	if (CachedSession && CachedSession->bShowInputLagDiagnostics)
 	{
-		if (Key == EKeys::MouseX || Key == EKeys::MouseY)
+		CachedSession->Tick(DeltaTime);
+
+		// Recorded input goes in where pumped input would, ahead of this frame's input processing
+		if (CachedSession->Recording.IsReplaying())
 		{
-			RecordInputTimestamp(Key);
+			ReplayInput(DeltaTime);
 		}
 	}
 
-	return Super::InputAxis(Key, Delta, DeltaTime, NumSamples, bGamepad);
+	Super::PlayerTick(DeltaTime);
 }
 
-void AInputLagPlayerController::MeasureInputLagEndOfFrame()
+bool AInputLagPlayerController::InputKey(FKey Key, EInputEvent EventType, float AmountDepressed, bool bGamepad)
 {
-	if (!bPendingInputMeasurement)
+	// A single flag test while diagnostics are off
+	if (CachedSession && CachedSession->bShowInputLagDiagnostics)
 	{
-		return;
+		// During a replay only the recorded stream drives the player
+		if (CachedSession->Recording.IsReplaying() && !bInjectingReplay)
+		{
+			return false;
+		}
+
+		if (CachedSession->Recording.IsRecording())
+		{
+			CachedSession->Recording.RecordKey(Key, EventType, AmountDepressed, bGamepad, FPlatformTime::Seconds());
+		}
+
+		// Record timestamp for mouse button presses
+		if (EventType == IE_Pressed && (Key == EKeys::LeftMouseButton || Key == EKeys::RightMouseButton))
+		{
+			CachedSession->OnInputKey(Key, EventType);
+		}
 	}
 
-	// Only measure if we're in a LATER frame than when input was recorded
-	// This ensures we're measuring "input frame N -> visual result appears in frame N+1"
-	if (GFrameCounter <= InputFrameNumber)
+	return Super::InputKey(Key, EventType, AmountDepressed, bGamepad);
+}
+
+bool AInputLagPlayerController::InputAxis(FKey Key, float Delta, float DeltaTime, int32 NumSamples, bool bGamepad)
+{
+	// A single flag test while diagnostics are off
+	if (CachedSession && CachedSession->bShowInputLagDiagnostics)
 	{
-		return; // Still in same frame, wait for next frame
-	}
+		// During a replay only the recorded stream drives the player
+		if (CachedSession->Recording.IsReplaying() && !bInjectingReplay)
+		{
+			return false;
+		}
 
-	// Measure at end of frame rendering (called from HUD's DrawHUD)
-	// This captures TRUE perceived input lag:
-	// - Input recorded in frame N
-	// - Game processes input in frame N
-	// - Frame N rendering completes
-	// - Measurement happens in frame N+1 DrawHUD
-	// - This gives us the time from "input arrives" to "frame with input's effect is ready"
-	double CurrentTime = FPlatformTime::Seconds();
-	float InputLagMs = (CurrentTime - LastInputTimestamp) * 1000.0f;
-
-	// Sanity check - if lag is impossibly high (> 1 second), skip it
-	if (InputLagMs > 0.0f && InputLagMs < 1000.0f)
-	{
-		// Store raw value
-		RawInputLag = InputLagMs;
-		
-		// Calculate smoothed value (exponential moving average: 90% old + 10% new)
-		// Similar to stat unit's smoothing
-		if (SmoothedInputLag == 0.0f)
+		if (CachedSession->Recording.IsRecording())
 		{
-			SmoothedInputLag = InputLagMs; // First sample
+			CachedSession->Recording.RecordAxis(Key, Delta, NumSamples, bGamepad, FPlatformTime::Seconds());
 		}
-		else
+
+		// Record timestamp for mouse movement (the session also accumulates the delta for verified mode)
+		// and how many raw events the viewport coalesced into this call
+		if (Key == EKeys::MouseX || Key == EKeys::MouseY)
 		{
-			SmoothedInputLag = 0.9f * SmoothedInputLag + 0.1f * InputLagMs;
+			CachedSession->OnInputAxis(Key, Delta);
+			CachedSession->OnInputAxisSamples(Key, NumSamples);
 		}
-		
-		// Add to circular buffer (no array shifting needed!)
-		InputLagHistory[HistoryIndex] = InputLagMs;
-		HistoryIndex = (HistoryIndex + 1) % MaxInputLagSamples;
 	}
 
-	// Reset
-	bPendingInputMeasurement = false;
-	LastInputTimestamp = 0.0;
-	InputFrameNumber = 0;
+	return Super::InputAxis(Key, Delta, DeltaTime, NumSamples, bGamepad);
+}
+
+void AInputLagPlayerController::MeasureInputLagEndOfFrame()
+{
+	// Measure at end of frame rendering (called from HUD's DrawHUD)
+	// Input recorded in frame N is measured in the first later frame whose HUD draws,
+	// giving the time from "input arrives" to "frame with input's effect is ready"
+	if (FInputLagDiagnostics* Session = GetSession())
+	{
+		Session->FinalizeInputLagMeasurement();
+	}
 }
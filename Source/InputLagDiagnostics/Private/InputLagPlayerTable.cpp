@@ -0,0 +1,49 @@
+#include "InputLagDiagnostics.h"
+#include "InputLagPlayerTable.h"
+
+FInputLagPlayerTable::FInputLagPlayerTable()
+	: CurrentFrameStart(0.0)
+{
+	// Every column is allocated once, here
+	InputTimestamp.AddZeroed(MaxPlayers);
+	InputFrame.AddZeroed(MaxPlayers);
+	TrackedKey.Init(EKeys::Invalid, MaxPlayers);
+	PendingMeasurement.Init(false, MaxPlayers);
+	PendingAxisDelta.AddZeroed(MaxPlayers);
+	LatchSequence.AddZeroed(MaxPlayers);
+	InputFrameStart.AddZeroed(MaxPlayers);
+	InputFrameEnd.AddZeroed(MaxPlayers);
+	SmoothedLag.AddZeroed(MaxPlayers);
+	RawLag.AddZeroed(MaxPlayers);
+	HistoryIndex.AddZeroed(MaxPlayers);
+	History.AddZeroed(MaxPlayers * HistoryCapacity);
+	Weights.AddZeroed(MaxPlayers * HistoryCapacity);
+}
+
+void FInputLagPlayerTable::ResetPending(int32 Slot)
+{
+	PendingMeasurement[Slot] = false;
+	InputTimestamp[Slot] = 0.0;
+	InputFrame[Slot] = 0;
+	PendingAxisDelta[Slot] = 0.0f;
+	LatchSequence[Slot] = 0;
+	InputFrameStart[Slot] = 0.0;
+	InputFrameEnd[Slot] = 0.0;
+}
+
+void FInputLagPlayerTable::BeginFrame(double Now)
+{
+	CurrentFrameStart = Now;
+}
+
+void FInputLagPlayerTable::EndFrame(double Now)
+{
+	// First frame end after an input arrived closes the frame it arrived in
+	for (int32 Slot = 0; Slot < MaxPlayers; ++Slot)
+	{
+		if (PendingMeasurement[Slot] && InputFrameEnd[Slot] == 0.0)
+		{
+			InputFrameEnd[Slot] = Now;
+		}
+	}
+}
@@ -0,0 +1,137 @@
+#include "InputLagDiagnostics.h"
+#include "InputLagPollingAnalyzer.h"
+#include "InputLagCore/InputLagCoreStats.h"
+
+const double FInputLagPollingAnalyzer::RefreshSeconds = 0.5;
+
+namespace
+{
+	// Events delivered in the same pump can share a timestamp; keep them as tiny non-empty intervals
+	const float MinIntervalMs = 0.0001f;
+
+	// Push into a fixed ring of floats
+	void PushRing(TArray<float>& Ring, int32& Index, int32& Count, float Value)
+	{
+		Ring[Index] = Value;
+		Index = (Index + 1) % Ring.Num();
+		Count = FMath::Min(Count + 1, Ring.Num());
+	}
+}
+
+FString FInputLagPollingStats::Describe() const
+{
+	FString AxisText = (NumAxisCalls > 0)
+		? FString::Printf(TEXT("%.1f per InputAxis (max %d)"), SamplesPerAxisCall, MaxSamplesPerAxisCall)
+		: FString(TEXT("per InputAxis n/a (needs AInputLagPlayerController)"));
+	return FString::Printf(TEXT("%.0f Hz, interval p50 %.2f / p99 %.2f ms, jitter %.2f ms, %.1f events/frame (max %d), %s"),
+		EffectiveRateHz, IntervalP50Ms, IntervalP99Ms, JitterMs, EventsPerFrame, MaxEventsPerFrame, *AxisText);
+}
+
+FInputLagPollingAnalyzer::FInputLagPollingAnalyzer()
+	: IntervalIndex(0)
+	, IntervalCount(0)
+	, FrameIndex(0)
+	, FrameCount(0)
+	, AxisIndex(0)
+	, AxisCount(0)
+	, LastEventTime(0.0)
+	, FrameStartTime(0.0)
+	, IdleGapMs((float)MinIdleGapMs)
+	, EventsThisFrame(0)
+	, LastRefreshTime(0.0)
+{
+	// Pre-allocate rings
+	Intervals.AddZeroed(MaxIntervals);
+	FrameEvents.AddZeroed(MaxFrames);
+	AxisSamples.AddZeroed(MaxFrames);
+}
+
+void FInputLagPollingAnalyzer::AddRawEvent(double Now)
+{
+	if (LastEventTime > 0.0)
+	{
+		float IntervalMs = (float)((Now - LastEventTime) * 1000.0);
+		if (IntervalMs < IdleGapMs)
+		{
+			PushRing(Intervals, IntervalIndex, IntervalCount, FMath::Max(IntervalMs, MinIntervalMs));
+		}
+	}
+
+	LastEventTime = Now;
+	EventsThisFrame++;
+}
+
+void FInputLagPollingAnalyzer::AddAxisCall(int32 NumSamples)
+{
+	if (NumSamples > 0)
+	{
+		PushRing(AxisSamples, AxisIndex, AxisCount, (float)NumSamples);
+	}
+}
+
+void FInputLagPollingAnalyzer::BeginFrame(double Now)
+{
+	// Events are pumped once per frame, so below 20 fps every gap between bursts would look idle
+	if (FrameStartTime > 0.0)
+	{
+		IdleGapMs = FMath::Max((float)MinIdleGapMs, (float)((Now - FrameStartTime) * 2000.0));
+	}
+	FrameStartTime = Now;
+
+	if (EventsThisFrame > 0)
+	{
+		PushRing(FrameEvents, FrameIndex, FrameCount, (float)EventsThisFrame);
+		EventsThisFrame = 0;
+	}
+
+	if (Now - LastRefreshTime >= RefreshSeconds)
+	{
+		LastRefreshTime = Now;
+		RefreshStats();
+	}
+}
+
+void FInputLagPollingAnalyzer::Reset()
+{
+	FMemory::Memzero(Intervals.GetData(), Intervals.Num() * sizeof(float));
+	FMemory::Memzero(FrameEvents.GetData(), FrameEvents.Num() * sizeof(float));
+	FMemory::Memzero(AxisSamples.GetData(), AxisSamples.Num() * sizeof(float));
+	IntervalIndex = IntervalCount = 0;
+	FrameIndex = FrameCount = 0;
+	AxisIndex = AxisCount = 0;
+	LastEventTime = 0.0;
+	FrameStartTime = 0.0;
+	IdleGapMs = (float)MinIdleGapMs;
+	EventsThisFrame = 0;
+	Stats = FInputLagPollingStats();
+}
+
+void FInputLagPollingAnalyzer::RefreshStats()
+{
+	Stats.NumIntervals = IntervalCount;
+	Stats.NumAxisCalls = AxisCount;
+	if (IntervalCount == 0)
+	{
+		return;
+	}
+
+	// Rate and jitter over moving spans only (idle gaps never enter the ring)
+	double Sum = 0.0;
+	double SumSquares = 0.0;
+	for (int32 Index = 0; Index < IntervalCount; ++Index)
+	{
+		Sum += Intervals[Index];
+		SumSquares += (double)Intervals[Index] * Intervals[Index];
+	}
+	double Mean = Sum / IntervalCount;
+
+	Stats.EffectiveRateHz = (Sum > 0.0) ? (float)(IntervalCount * 1000.0 / Sum) : 0.0f;
+	Stats.JitterMs = (float)FMath::Sqrt(FMath::Max(SumSquares / IntervalCount - Mean * Mean, 0.0));
+	Stats.IntervalP50Ms = InputLagCore::WeightedPercentile(Intervals.GetData(), nullptr, IntervalCount, 0.5f);
+	Stats.IntervalP99Ms = InputLagCore::WeightedPercentile(Intervals.GetData(), nullptr, IntervalCount, 0.99f);
+
+	Stats.EventsPerFrame = InputLagCore::WeightedAverage(FrameEvents.GetData(), nullptr, FrameCount);
+	Stats.MaxEventsPerFrame = FMath::RoundToInt(InputLagCore::MaxValue(FrameEvents.GetData(), FrameCount));
+	Stats.SamplesPerAxisCall = InputLagCore::WeightedAverage(AxisSamples.GetData(), nullptr, AxisCount);
+	Stats.MaxSamplesPerAxisCall = FMath::RoundToInt(InputLagCore::MaxValue(AxisSamples.GetData(), AxisCount));
+}
@@ -0,0 +1,165 @@
+#include "InputLagDiagnostics.h"
+#include "InputLagReporter.h"
+#include "InputLagDiagnosticsMutator.h"
+#include "InputLagMeasurementService.h"
+#include "InputLagSketch.h"
+
+namespace
+{
+	// Damage scored longer than this after the last fire tag is not that click's hit (slow projectiles, damage over time)
+	const double MaxHitConfirmSeconds = 1.0;
+}
+
+AInputLagReporter::AInputLagReporter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+	, Mutator(nullptr)
+	, PendingFireTag(0)
+	, PendingFireTime(0.0)
+{
+	ReportInterval = 5.0f;
+
+	// Only the owning client needs this actor
+	bReplicates = true;
+	bOnlyRelevantToOwner = true;
+	bAlwaysRelevant = false;
+	NetUpdateFrequency = 1.0f;
+	PrimaryActorTick.bCanEverTick = false;
+}
+
+void AInputLagReporter::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Anything with a local player may be the owning client (including a listen server host)
+	if (GetNetMode() != NM_DedicatedServer)
+	{
+		GetWorldTimerManager().SetTimer(ReportTimerHandle, this, &AInputLagReporter::SendReport, ReportInterval, true);
+
+		// Fire tags must go out with the click, not with the next report
+		GetLocalSession();
+	}
+}
+
+void AInputLagReporter::OnRep_Owner()
+{
+	Super::OnRep_Owner();
+
+	// On remote clients the owner usually arrives after BeginPlay
+	GetLocalSession();
+}
+
+void AInputLagReporter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	GetWorldTimerManager().ClearTimer(ReportTimerHandle);
+
+	FInputLagMeasurementService* Service = FInputLagDiagnosticsModule::Get().GetService();
+	if (Service)
+	{
+		FInputLagDiagnostics* Session = Service->Resolve(SessionHandle);
+		if (Session && FireTaggedHandle.IsValid())
+		{
+			Session->OnFireTagged.Remove(FireTaggedHandle);
+		}
+		FireTaggedHandle.Reset();
+
+		// Not the session's owner - leave its controller binding alone
+		Service->Detach(SessionHandle, nullptr);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+FInputLagDiagnostics* AInputLagReporter::GetLocalSession()
+{
+	APlayerController* PC = Cast<APlayerController>(GetOwner());
+	FInputLagMeasurementService* Service = FInputLagDiagnosticsModule::Get().GetService();
+	if (!PC || !PC->IsLocalController() || !Service)
+	{
+		return nullptr;
+	}
+
+	if (!SessionHandle.IsValid())
+	{
+		SessionHandle = Service->Attach(FInputLagMeasurementService::GetLocalPlayerSlot(PC));
+	}
+
+	FInputLagDiagnostics* Session = Service->Resolve(SessionHandle);
+	if (Session && !FireTaggedHandle.IsValid())
+	{
+		FireTaggedHandle = Session->OnFireTagged.AddUObject(this, &AInputLagReporter::OnFireTagged);
+	}
+	return Session;
+}
+
+void AInputLagReporter::OnFireTagged(uint16 FireTag)
+{
+	ServerFireTag(FireTag);
+}
+
+void AInputLagReporter::SendReport()
+{
+	FInputLagDiagnostics* Session = GetLocalSession();
+	if (!Session || Session->ReportSketch.GetTotalCount() == 0)
+	{
+		return;
+	}
+
+	// At most NumBuckets x 2 bytes; anything over 65535 per bucket waits for the next report
+	TArray<uint16> Counts;
+	Session->ReportSketch.ExtractCounts(Counts);
+	ServerReportSketch(Counts);
+}
+
+bool AInputLagReporter::ServerReportSketch_Validate(const TArray<uint16>& Counts)
+{
+	return Counts.Num() <= FInputLagSketch::NumBuckets;
+}
+
+void AInputLagReporter::ServerReportSketch_Implementation(const TArray<uint16>& Counts)
+{
+	// The client has already cleared these counts, so even reports bunched up by the network are merged;
+	// validation bounds the size of each one and merging is a fixed pass over the buckets
+	APlayerController* PC = Cast<APlayerController>(GetOwner());
+	if (Mutator && PC)
+	{
+		Mutator->ReceiveSketch(PC, Counts);
+	}
+}
+
+bool AInputLagReporter::ServerFireTag_Validate(uint16 FireTag)
+{
+	return FireTag != 0;
+}
+
+void AInputLagReporter::ServerFireTag_Implementation(uint16 FireTag)
+{
+	// Only the latest click can be confirmed; an earlier unconfirmed one was a miss
+	PendingFireTag = FireTag;
+	PendingFireTime = FPlatformTime::Seconds();
+}
+
+void AInputLagReporter::ConfirmHit()
+{
+	if (PendingFireTag == 0)
+	{
+		return;
+	}
+
+	double HeldSeconds = FPlatformTime::Seconds() - PendingFireTime;
+	if (HeldSeconds <= MaxHitConfirmSeconds)
+	{
+		ClientConfirmHit(PendingFireTag, (float)(HeldSeconds * 1000.0));
+	}
+
+	// First hit per click (shotgun pellets and splash score several times)
+	PendingFireTag = 0;
+}
+
+void AInputLagReporter::ClientConfirmHit_Implementation(uint16 FireTag, float ServerMs)
+{
+	FInputLagDiagnostics* Session = GetLocalSession();
+	if (Session)
+	{
+		Session->OnHitConfirmed(FireTag, ServerMs);
+	}
+}
@@ -0,0 +1,256 @@
+#include "InputLagDiagnostics.h"
+#include "InputLagSampler.h"
+#include "InputLagCore/InputLagCoreStats.h"
+
+FInputLagSampler::FInputLagSampler()
+	: Mode(EInputLagSamplingMode::Auto)
+	, SampleEveryN(4)
+	, StrideSeconds(0.05)
+	, FrameBudgetSeconds(0.0001)
+	, OffersSinceSample(0)
+	, TotalOffers(0)
+	, AutoStride(1)
+	, QuietFrames(0)
+	, LastSampleTime(0.0)
+	, PendingSampleWeight(1.0f)
+	, PendingReservoirSlot(INDEX_NONE)
+	, FrameWorkCycles(0)
+	, LastFrameWorkSeconds(0.0)
+	, ReservoirCount(0)
+	, RandomState((uint64)FDateTime::Now().GetTicks() | 1)
+{
+	// Pre-allocate reservoir
+	Reservoir.AddZeroed(ReservoirCapacity);
+}
+
+int64 FInputLagSampler::RandomOffer(int64 Range)
+{
+	RandomState ^= RandomState >> 12;
+	RandomState ^= RandomState << 25;
+	RandomState ^= RandomState >> 27;
+	return (int64)((RandomState * 2685821657736338717ULL) % (uint64)Range);
+}
+
+void FInputLagSampler::CountBusyOffer()
+{
+	OffersSinceSample++;
+}
+
+bool FInputLagSampler::ShouldSample(double Now)
+{
+	OffersSinceSample++;
+
+	// Hard budget: once this frame's measurement work is used up, no further inputs are measured.
+	// The skipped inputs still count towards the weight of the next accepted sample.
+	if (FrameWorkCycles * FPlatformTime::GetSecondsPerCycle() >= FrameBudgetSeconds)
+	{
+		return false;
+	}
+
+	bool bAccept = false;
+	switch (Mode)
+	{
+	case EInputLagSamplingMode::All:
+		bAccept = true;
+		break;
+
+	case EInputLagSamplingMode::EveryNth:
+		bAccept = OffersSinceSample >= FMath::Max(SampleEveryN, 1);
+		break;
+
+	case EInputLagSamplingMode::Auto:
+		bAccept = OffersSinceSample >= AutoStride;
+		break;
+
+	case EInputLagSamplingMode::TimeStride:
+		bAccept = (Now - LastSampleTime) >= StrideSeconds;
+		break;
+
+	case EInputLagSamplingMode::Reservoir:
+	{
+		// Algorithm R: the i-th offer enters the reservoir with probability K / i, so the reservoir is
+		// always a uniform sample of the offers it saw. Only offers that could be measured count towards
+		// i - busy and over-budget offers never get a draw, and counting them would favour early inputs.
+		TotalOffers++;
+		if (ReservoirCount < ReservoirCapacity)
+		{
+			PendingReservoirSlot = ReservoirCount++;
+			bAccept = true;
+		}
+		else
+		{
+			int64 Slot = RandomOffer(TotalOffers);
+			if (Slot < ReservoirCapacity)
+			{
+				PendingReservoirSlot = (int32)Slot;
+				bAccept = true;
+			}
+		}
+		break;
+	}
+	}
+
+	if (bAccept)
+	{
+		// Each accepted sample stands for every input offered since the previous one.
+		// Reservoir samples are already uniform, so they all carry the same weight.
+		PendingSampleWeight = (Mode == EInputLagSamplingMode::Reservoir) ? 1.0f : (float)OffersSinceSample;
+		OffersSinceSample = 0;
+		LastSampleTime = Now;
+	}
+
+	return bAccept;
+}
+
+void FInputLagSampler::AddMeasurement(float LagMs)
+{
+	if (PendingReservoirSlot != INDEX_NONE)
+	{
+		Reservoir[PendingReservoirSlot] = LagMs;
+		PendingReservoirSlot = INDEX_NONE;
+	}
+}
+
+void FInputLagSampler::DropMeasurement()
+{
+	// A slot taken while filling is handed back, so the filled slots stay contiguous
+	if (PendingReservoirSlot != INDEX_NONE && PendingReservoirSlot == ReservoirCount - 1 && Reservoir[PendingReservoirSlot] == 0.0f)
+	{
+		ReservoirCount--;
+	}
+	PendingReservoirSlot = INDEX_NONE;
+}
+
+void FInputLagSampler::BeginFrame()
+{
+	LastFrameWorkSeconds = FrameWorkCycles * FPlatformTime::GetSecondsPerCycle();
+	FrameWorkCycles = 0;
+
+	if (Mode != EInputLagSamplingMode::Auto)
+	{
+		return;
+	}
+
+	// Degrade quickly when over budget, recover slowly once comfortably under it
+	if (LastFrameWorkSeconds > FrameBudgetSeconds)
+	{
+		AutoStride = FMath::Min(AutoStride * 2, MaxAutoStride);
+		QuietFrames = 0;
+	}
+	else if (AutoStride > 1 && LastFrameWorkSeconds < FrameBudgetSeconds * 0.5)
+	{
+		if (++QuietFrames >= AutoRecoverFrames)
+		{
+			AutoStride = FMath::Max(AutoStride / 2, 1);
+			QuietFrames = 0;
+		}
+	}
+}
+
+bool FInputLagSampler::IsSampling() const
+{
+	return GetEffectiveStride() > 1 || Mode == EInputLagSamplingMode::TimeStride || Mode == EInputLagSamplingMode::Reservoir;
+}
+
+int32 FInputLagSampler::GetEffectiveStride() const
+{
+	switch (Mode)
+	{
+	case EInputLagSamplingMode::EveryNth:
+		return FMath::Max(SampleEveryN, 1);
+	case EInputLagSamplingMode::Auto:
+		return AutoStride;
+	default:
+		return 1;
+	}
+}
+
+float FInputLagSampler::GetReservoirPercentile(float Percentile) const
+{
+	return GetWeightedPercentile(Reservoir.GetData(), nullptr, ReservoirCount, Percentile);
+}
+
+float FInputLagSampler::GetReservoirAverage() const
+{
+	return GetWeightedAverage(Reservoir.GetData(), nullptr, ReservoirCount);
+}
+
+FString FInputLagSampler::GetModeName() const
+{
+	switch (Mode)
+	{
+	case EInputLagSamplingMode::All:
+		return TEXT("All");
+	case EInputLagSamplingMode::EveryNth:
+		return FString::Printf(TEXT("Every %d"), FMath::Max(SampleEveryN, 1));
+	case EInputLagSamplingMode::TimeStride:
+		return FString::Printf(TEXT("Stride %.0f ms"), StrideSeconds * 1000.0);
+	case EInputLagSamplingMode::Reservoir:
+		return FString::Printf(TEXT("Reservoir %d/%d"), ReservoirCount, ReservoirCapacity);
+	case EInputLagSamplingMode::Auto:
+		return (AutoStride > 1) ? FString::Printf(TEXT("Auto (1/%d)"), AutoStride) : FString(TEXT("Auto"));
+	}
+	return FString();
+}
+
+bool FInputLagSampler::SetModeFromString(const FString& ModeName, const FString& Param)
+{
+	if (ModeName.Equals(TEXT("all"), ESearchCase::IgnoreCase))
+	{
+		Mode = EInputLagSamplingMode::All;
+	}
+	else if (ModeName.Equals(TEXT("nth"), ESearchCase::IgnoreCase))
+	{
+		int32 N = FCString::Atoi(*Param);
+		if (N < 1)
+		{
+			return false;
+		}
+		Mode = EInputLagSamplingMode::EveryNth;
+		SampleEveryN = N;
+	}
+	else if (ModeName.Equals(TEXT("stride"), ESearchCase::IgnoreCase))
+	{
+		float StrideMs = FCString::Atof(*Param);
+		if (StrideMs <= 0.0f)
+		{
+			return false;
+		}
+		Mode = EInputLagSamplingMode::TimeStride;
+		StrideSeconds = StrideMs / 1000.0;
+	}
+	else if (ModeName.Equals(TEXT("reservoir"), ESearchCase::IgnoreCase))
+	{
+		Mode = EInputLagSamplingMode::Reservoir;
+	}
+	else if (ModeName.Equals(TEXT("auto"), ESearchCase::IgnoreCase))
+	{
+		Mode = EInputLagSamplingMode::Auto;
+		AutoStride = 1;
+		QuietFrames = 0;
+
+		float BudgetMs = FCString::Atof(*Param);
+		if (BudgetMs > 0.0f)
+		{
+			FrameBudgetSeconds = BudgetMs / 1000.0;
+		}
+	}
+	else
+	{
+		return false;
+	}
+
+	OffersSinceSample = 0;
+	PendingReservoirSlot = INDEX_NONE;
+	return true;
+}
+
+float FInputLagSampler::GetWeightedPercentile(const float* Values, const float* Weights, int32 Num, float Percentile)
+{
+	return InputLagCore::WeightedPercentile(Values, Weights, Num, Percentile);
+}
+
+float FInputLagSampler::GetWeightedAverage(const float* Values, const float* Weights, int32 Num)
+{
+	return InputLagCore::WeightedAverage(Values, Weights, Num);
+}
@@ -0,0 +1,29 @@
+#include "InputLagDiagnostics.h"
+#include "InputLagSketch.h"
+
+void FInputLagSketch::MergeCounts(const TArray<uint16>& InCounts)
+{
+	int32 Num = FMath::Min(InCounts.Num(), (int32)NumBuckets);
+	for (int32 Bucket = 0; Bucket < Num; ++Bucket)
+	{
+		Histogram.AddToBucket(Bucket, InCounts[Bucket]);
+	}
+}
+
+void FInputLagSketch::ExtractCounts(TArray<uint16>& OutCounts)
+{
+	OutCounts.Reset(NumBuckets);
+
+	int32 LastUsed = INDEX_NONE;
+	for (int32 Bucket = 0; Bucket < NumBuckets; ++Bucket)
+	{
+		uint64 Taken = Histogram.TakeFromBucket(Bucket, MAX_uint16);
+		OutCounts.Add((uint16)Taken);
+		if (Taken > 0)
+		{
+			LastUsed = Bucket;
+		}
+	}
+
+	OutCounts.SetNum(LastUsed + 1);
+}
@@ -0,0 +1,309 @@
+#include "InputLagDiagnostics.h"
+#include "InputLagSweep.h"
+#include "Engine.h"
+
+FString FInputLagSweepConfig::Describe() const
+{
+	return FString::Printf(TEXT("MaxFPS=%.0f OneFrameThreadLag=%d VSync=%d FinishCurrentFrame=%d Smooth=%d"),
+		MaxFPS, OneFrameThreadLag, VSync, FinishCurrentFrame, bSmoothFrameRate ? 1 : 0);
+}
+
+FInputLagSweep::FInputLagSweep()
+	: SamplesPerConfig(200)
+	, WarmupFrames(60)
+	, ConfigTimeoutSeconds(30.0f)
+	, bSyntheticInput(true)
+	, CurrentConfig(0)
+	, WarmupFramesLeft(0)
+	, ConfigElapsed(0.0f)
+	, bRunning(false)
+	, bOriginalSmoothFrameRate(false)
+{
+}
+
+bool FInputLagSweep::Start(const FString& InProfileName)
+{
+	if (bRunning)
+	{
+		Stop();
+	}
+
+	ProfileName = InProfileName.IsEmpty() ? FString(TEXT("Default")) : InProfileName;
+	LoadProfile();
+
+	if (Results.Num() == 0)
+	{
+		return false;
+	}
+
+	CaptureOriginalSettings();
+
+	bRunning = true;
+	CurrentConfig = 0;
+	ConfigElapsed = 0.0f;
+	WarmupFramesLeft = WarmupFrames;
+	ApplyConfig(Results[CurrentConfig].Config);
+
+	UE_LOG(LogTemp, Warning, TEXT("InputLag Sweep: Started profile '%s' with %d configurations"), *ProfileName, Results.Num());
+	return true;
+}
+
+void FInputLagSweep::Stop()
+{
+	if (!bRunning)
+	{
+		return;
+	}
+
+	bRunning = false;
+	RestoreOriginalSettings();
+
+	if (WriteReport())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("InputLag Sweep: Report written to %s"), *ReportPath);
+	}
+	else
+	{
+		UE_LOG(LogTemp, Warning, TEXT("InputLag Sweep: Failed to write report to %s"), *ReportPath);
+	}
+}
+
+void FInputLagSweep::Tick(float DeltaTime)
+{
+	if (!bRunning)
+	{
+		return;
+	}
+
+	// Let the new settings settle before counting anything
+	if (WarmupFramesLeft > 0)
+	{
+		WarmupFramesLeft--;
+		return;
+	}
+
+	FInputLagSweepResult& Result = Results[CurrentConfig];
+	Result.FrameTimeSum += DeltaTime;
+	Result.FrameCount++;
+	ConfigElapsed += DeltaTime;
+
+	bool bDone = Result.Samples.Num() >= SamplesPerConfig;
+	if (!bDone && ConfigElapsed >= ConfigTimeoutSeconds)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("InputLag Sweep: Timed out on %s with %d samples"), *Result.Config.Describe(), Result.Samples.Num());
+		bDone = true;
+	}
+
+	if (bDone)
+	{
+		if (++CurrentConfig >= Results.Num())
+		{
+			Stop();
+			return;
+		}
+
+		ConfigElapsed = 0.0f;
+		WarmupFramesLeft = WarmupFrames;
+		ApplyConfig(Results[CurrentConfig].Config);
+	}
+}
+
+void FInputLagSweep::AddSample(float LagMs)
+{
+	if (!bRunning || WarmupFramesLeft > 0)
+	{
+		return;
+	}
+
+	FInputLagSweepResult& Result = Results[CurrentConfig];
+	if (Result.Samples.Num() < SamplesPerConfig)
+	{
+		Result.Samples.Add(LagMs);
+	}
+}
+
+FString FInputLagSweep::GetStatusText() const
+{
+	if (!bRunning)
+	{
+		return FString();
+	}
+
+	const FInputLagSweepResult& Result = Results[CurrentConfig];
+	return FString::Printf(TEXT("%d/%d %s  %d/%d%s"), CurrentConfig + 1, Results.Num(), *Result.Config.Describe(),
+		Result.Samples.Num(), SamplesPerConfig, (WarmupFramesLeft > 0) ? TEXT(" (warmup)") : TEXT(""));
+}
+
+void FInputLagSweep::LoadProfile()
+{
+	Results.Empty();
+
+	FString Section = FString::Printf(TEXT("InputLagSweep.%s"), *ProfileName);
+	bool bHasSection = GConfig && GConfig->GetSectionPrivate(*Section, false, true, GGameIni) != nullptr;
+
+	if (bHasSection)
+	{
+		GConfig->GetInt(*Section, TEXT("SamplesPerConfig"), SamplesPerConfig, GGameIni);
+		GConfig->GetInt(*Section, TEXT("WarmupFrames"), WarmupFrames, GGameIni);
+		GConfig->GetFloat(*Section, TEXT("ConfigTimeoutSeconds"), ConfigTimeoutSeconds, GGameIni);
+		GConfig->GetBool(*Section, TEXT("SyntheticInput"), bSyntheticInput, GGameIni);
+		SamplesPerConfig = FMath::Max(SamplesPerConfig, 1);
+		WarmupFrames = FMath::Max(WarmupFrames, 0);
+	}
+	else
+	{
+		UE_LOG(LogTemp, Warning, TEXT("InputLag Sweep: No [%s] section in Game.ini, using the built-in matrix"), *Section);
+	}
+
+	// Missing keys keep the current value, so the built-in matrix only varies the frame cap and thread lag
+	TArray<float> MaxFPSValues = bHasSection ? ReadList(Section, TEXT("MaxFPS"), FCString::Atof(*GetConsoleVariable(TEXT("t.MaxFPS"))))
+		: TArray<float>({ 0.0f, 60.0f, 120.0f, 240.0f });
+	TArray<float> ThreadLagValues = bHasSection ? ReadList(Section, TEXT("OneFrameThreadLag"), FCString::Atof(*GetConsoleVariable(TEXT("r.OneFrameThreadLag"))))
+		: TArray<float>({ 1.0f, 0.0f });
+	TArray<float> VSyncValues = ReadList(Section, TEXT("VSync"), FCString::Atof(*GetConsoleVariable(TEXT("r.VSync"))));
+	TArray<float> FinishFrameValues = ReadList(Section, TEXT("FinishCurrentFrame"), FCString::Atof(*GetConsoleVariable(TEXT("r.FinishCurrentFrame"))));
+	TArray<float> SmoothValues = ReadList(Section, TEXT("SmoothFrameRate"), (GEngine && GEngine->bSmoothFrameRate) ? 1.0f : 0.0f);
+
+	// Cartesian product of every list
+	for (float MaxFPS : MaxFPSValues)
+	{
+		for (float ThreadLag : ThreadLagValues)
+		{
+			for (float VSync : VSyncValues)
+			{
+				for (float FinishFrame : FinishFrameValues)
+				{
+					for (float Smooth : SmoothValues)
+					{
+						FInputLagSweepResult Result;
+						Result.Config.MaxFPS = MaxFPS;
+						Result.Config.OneFrameThreadLag = FMath::RoundToInt(ThreadLag);
+						Result.Config.VSync = FMath::RoundToInt(VSync);
+						Result.Config.FinishCurrentFrame = FMath::RoundToInt(FinishFrame);
+						Result.Config.bSmoothFrameRate = Smooth != 0.0f;
+						Result.Samples.Reserve(SamplesPerConfig);
+						Results.Add(Result);
+					}
+				}
+			}
+		}
+	}
+}
+
+TArray<float> FInputLagSweep::ReadList(const FString& Section, const TCHAR* Key, float CurrentValue)
+{
+	TArray<float> Values;
+
+	FString ListString;
+	if (GConfig && GConfig->GetString(*Section, Key, ListString, GGameIni))
+	{
+		TArray<FString> Entries;
+		ListString.ParseIntoArray(Entries, TEXT(","), true);
+		for (const FString& Entry : Entries)
+		{
+			Values.Add(FCString::Atof(*Entry.Trim().TrimTrailing()));
+		}
+	}
+
+	if (Values.Num() == 0)
+	{
+		Values.Add(CurrentValue);
+	}
+	return Values;
+}
+
+void FInputLagSweep::ApplyConfig(const FInputLagSweepConfig& Config)
+{
+	SetConsoleVariable(TEXT("t.MaxFPS"), FString::SanitizeFloat(Config.MaxFPS));
+	SetConsoleVariable(TEXT("r.OneFrameThreadLag"), FString::FromInt(Config.OneFrameThreadLag));
+	SetConsoleVariable(TEXT("r.VSync"), FString::FromInt(Config.VSync));
+	SetConsoleVariable(TEXT("r.FinishCurrentFrame"), FString::FromInt(Config.FinishCurrentFrame));
+	if (GEngine)
+	{
+		GEngine->bSmoothFrameRate = Config.bSmoothFrameRate;
+	}
+
+	UE_LOG(LogTemp, Warning, TEXT("InputLag Sweep: Applied %s"), *Config.Describe());
+}
+
+void FInputLagSweep::CaptureOriginalSettings()
+{
+	OriginalSettings.Empty();
+	OriginalSettings.Add(TEXT("t.MaxFPS"), GetConsoleVariable(TEXT("t.MaxFPS")));
+	OriginalSettings.Add(TEXT("r.OneFrameThreadLag"), GetConsoleVariable(TEXT("r.OneFrameThreadLag")));
+	OriginalSettings.Add(TEXT("r.VSync"), GetConsoleVariable(TEXT("r.VSync")));
+	OriginalSettings.Add(TEXT("r.FinishCurrentFrame"), GetConsoleVariable(TEXT("r.FinishCurrentFrame")));
+	bOriginalSmoothFrameRate = GEngine ? GEngine->bSmoothFrameRate : false;
+}
+
+void FInputLagSweep::RestoreOriginalSettings()
+{
+	for (const auto& Setting : OriginalSettings)
+	{
+		SetConsoleVariable(*Setting.Key, Setting.Value);
+	}
+	if (GEngine)
+	{
+		GEngine->bSmoothFrameRate = bOriginalSmoothFrameRate;
+	}
+}
+
+FString FInputLagSweep::GetConsoleVariable(const TCHAR* Name)
+{
+	IConsoleVariable* Variable = IConsoleManager::Get().FindConsoleVariable(Name);
+	return Variable ? Variable->GetString() : FString();
+}
+
+void FInputLagSweep::SetConsoleVariable(const TCHAR* Name, const FString& Value)
+{
+	IConsoleVariable* Variable = IConsoleManager::Get().FindConsoleVariable(Name);
+	if (Variable && !Value.IsEmpty())
+	{
+		Variable->Set(*Value, ECVF_SetByConsole);
+	}
+}
+
+bool FInputLagSweep::WriteReport()
+{
+	FString Timestamp = FDateTime::Now().ToString(TEXT("%Y%m%d_%H%M%S"));
+	// The profile name comes from a mutate command; keep separators and the like out of the path
+	ReportPath = FPaths::GameSavedDir() + TEXT("Logs/InputLagSweep_") + FPaths::MakeValidFileName(ProfileName, TEXT('_')) + TEXT("_") + Timestamp + TEXT(".csv");
+
+	FString Report = TEXT("MaxFPS,OneFrameThreadLag,VSync,FinishCurrentFrame,SmoothFrameRate,Samples,AvgFrame_ms,Min_ms,Avg_ms,P50_ms,P95_ms,P99_ms,Max_ms\n");
+
+	for (const FInputLagSweepResult& Result : Results)
+	{
+		TArray<float> Sorted = Result.Samples;
+		Sorted.Sort();
+
+		auto Percentile = [&Sorted](float Fraction) -> float
+		{
+			if (Sorted.Num() == 0)
+			{
+				return 0.0f;
+			}
+			int32 Index = FMath::Clamp(FMath::CeilToInt(Sorted.Num() * Fraction) - 1, 0, Sorted.Num() - 1);
+			return Sorted[Index];
+		};
+
+		float Sum = 0.0f;
+		for (float Lag : Sorted)
+		{
+			Sum += Lag;
+		}
+
+		float AvgLag = (Sorted.Num() > 0) ? Sum / Sorted.Num() : 0.0f;
+		float AvgFrameMs = (Result.FrameCount > 0) ? (float)(Result.FrameTimeSum / Result.FrameCount * 1000.0) : 0.0f;
+
+		Report += FString::Printf(TEXT("%.0f,%d,%d,%d,%d,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n"),
+			Result.Config.MaxFPS, Result.Config.OneFrameThreadLag, Result.Config.VSync, Result.Config.FinishCurrentFrame,
+			Result.Config.bSmoothFrameRate ? 1 : 0, Sorted.Num(), AvgFrameMs,
+			Sorted.Num() > 0 ? Sorted[0] : 0.0f, AvgLag, Percentile(0.5f), Percentile(0.95f), Percentile(0.99f),
+			Sorted.Num() > 0 ? Sorted.Last() : 0.0f);
+
+		UE_LOG(LogTemp, Warning, TEXT("InputLag Sweep: %s -> %d samples, avg %.2f ms, p95 %.2f ms"),
+			*Result.Config.Describe(), Sorted.Num(), AvgLag, Percentile(0.95f));
+	}
+
+	return FFileHelper::SaveStringToFile(Report, *ReportPath);
+}
@@ -0,0 +1,133 @@
+#include "InputLagDiagnostics.h"
+#include "InputLagTrace.h"
+
+FInputLagTrace::FInputLagTrace()
+	: BaseTime(0.0)
+	, OpenFlowId(0)
+	, NextFlowId(1)
+	, OpenFlowKey(EKeys::Invalid)
+	, bOpenFlowConsumed(false)
+	, EventCount(0)
+{
+}
+
+bool FInputLagTrace::Start(int32 PlayerSlot)
+{
+	FString LogsDir = FPaths::GameSavedDir() + TEXT("Logs/");
+	FString Timestamp = FDateTime::Now().ToString(TEXT("%Y%m%d_%H%M%S"));
+	if (!Writer.Open(LogsDir + TEXT("InputLagTrace_") + Timestamp + TEXT(".json")))
+	{
+		return false;
+	}
+
+	BaseTime = FPlatformTime::Seconds();
+	OpenFlowId = 0;
+	EventCount = 0;
+	Writer.Write(TEXT("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"));
+
+	// Name the process and tracks so the viewer shows readable lanes
+	Emit(FString::Printf(TEXT("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Input Lag - Player %d\"}}"), PlayerSlot + 1));
+	Emit(FString::Printf(TEXT("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"Frames\"}}"), (int32)EInputLagTraceTrack::Frames));
+	Emit(FString::Printf(TEXT("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"Input Arrival\"}}"), (int32)EInputLagTraceTrack::Input));
+	Emit(FString::Printf(TEXT("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"Game Thread\"}}"), (int32)EInputLagTraceTrack::GameThread));
+	Emit(FString::Printf(TEXT("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"HUD Draw\"}}"), (int32)EInputLagTraceTrack::HUD));
+	return true;
+}
+
+void FInputLagTrace::Stop()
+{
+	if (!IsActive())
+	{
+		return;
+	}
+
+	DropInput(FPlatformTime::Seconds(), GFrameCounter);
+	Writer.Write(TEXT("\n]}\n"));
+	Writer.Close();
+}
+
+void FInputLagTrace::AddFrame(uint64 Frame, double StartTime, double EndTime)
+{
+	if (!IsActive() || StartTime < BaseTime)
+	{
+		return;
+	}
+
+	Emit(FString::Printf(TEXT("{\"name\":\"Frame\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%llu}}"),
+		(int32)EInputLagTraceTrack::Frames, ToMicroseconds(StartTime), (EndTime - StartTime) * 1000000.0, Frame));
+}
+
+void FInputLagTrace::BeginInput(const FKey& Key, double Time, uint64 Frame)
+{
+	if (!IsActive())
+	{
+		return;
+	}
+
+	DropInput(Time, Frame);
+
+	OpenFlowId = NextFlowId++;
+	OpenFlowKey = Key;
+	bOpenFlowConsumed = false;
+	AddFlowStage(EInputLagTraceTrack::Input, TEXT("Arrival"), TEXT('s'), Time, Frame, FString());
+}
+
+void FInputLagTrace::MarkConsumed(double Time, uint64 Frame)
+{
+	if (OpenFlowId == 0 || bOpenFlowConsumed)
+	{
+		return;
+	}
+
+	bOpenFlowConsumed = true;
+	AddFlowStage(EInputLagTraceTrack::GameThread, TEXT("Consumed"), TEXT('t'), Time, Frame, FString());
+}
+
+void FInputLagTrace::MarkDraw(double Time, uint64 Frame)
+{
+	if (OpenFlowId == 0)
+	{
+		return;
+	}
+
+	AddFlowStage(EInputLagTraceTrack::HUD, TEXT("HUD Draw"), TEXT('t'), Time, Frame, FString());
+}
+
+void FInputLagTrace::CompleteInput(double Time, uint64 Frame, float LagMs)
+{
+	if (OpenFlowId == 0)
+	{
+		return;
+	}
+
+	AddFlowStage(EInputLagTraceTrack::HUD, TEXT("Measured"), TEXT('f'), Time, Frame, FString::Printf(TEXT(",\"lag_ms\":%.3f"), LagMs));
+	OpenFlowId = 0;
+}
+
+void FInputLagTrace::DropInput(double Time, uint64 Frame)
+{
+	if (OpenFlowId == 0)
+	{
+		return;
+	}
+
+	AddFlowStage(EInputLagTraceTrack::HUD, TEXT("Dropped"), TEXT('f'), Time, Frame, FString());
+	OpenFlowId = 0;
+}
+
+void FInputLagTrace::AddFlowStage(EInputLagTraceTrack Track, const TCHAR* StageName, TCHAR FlowPhase, double Time, uint64 Frame, const FString& ExtraArgs)
+{
+	double Ts = ToMicroseconds(Time);
+
+	// A 1 us slice gives the flow arrow something to bind to ("bp":"e" = enclosing slice)
+	Emit(FString::Printf(TEXT("{\"name\":\"%s\",\"cat\":\"input\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":1,\"args\":{\"key\":\"%s\",\"input\":%u,\"frame\":%llu%s}}"),
+		StageName, (int32)Track, Ts, *OpenFlowKey.ToString(), OpenFlowId, Frame, *ExtraArgs));
+	Emit(FString::Printf(TEXT("{\"name\":\"Input\",\"cat\":\"input\",\"ph\":\"%c\",\"bp\":\"e\",\"id\":%u,\"pid\":1,\"tid\":%d,\"ts\":%.3f}"),
+		FlowPhase, OpenFlowId, (int32)Track, Ts));
+}
+
+void FInputLagTrace::Emit(const FString& Event)
+{
+	Writer.Write(EventCount > 0 ? TEXT(",\n") + Event : Event);
+	EventCount++;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Core.h"
+
+/** Lag split into its parts, averaged over a set of samples (milliseconds unless noted) */
+struct FInputLagBreakdown
+{
+	float LagMs;
+
+	// Input arrival to the end of the frame it arrived in
+	float WaitMs;
+
+	// Whole game frames after the input's frame until the one the render thread finished the sample's
+	// frame in, and the frame time
+	float Frames;
+	float FrameTimeMs;
+
+	// Start of that last game frame to the render thread finishing (render-thread queueing)
+	float QueueMs;
+
+	// What the parts above do not explain (frame-time variance around the average)
+	float OtherMs;
+
+	FInputLagBreakdown()
+		: LagMs(0.0f)
+		, WaitMs(0.0f)
+		, Frames(0.0f)
+		, FrameTimeMs(0.0f)
+		, QueueMs(0.0f)
+		, OtherMs(0.0f)
+	{
+	}
+
+	// One-line description ("28 ms = 4 wait + 2.1 frames x 11 ms + 5 queue + 1 other")
+	FString Describe() const;
+};
+
+/**
+ * Online lag attribution
+ * Every sample's lag until the render thread finished its frame is split into within-frame wait,
+ * pipelined frames times frame time, and queueing into the game frame the render thread finished
+ * in, with the remainder as other. Decaying sums of each part are kept
+ * over all samples and over the tail (samples at or above the current p95), so adding a sample
+ * is constant work and the breakdown follows the recent state of the game. The tail breakdown
+ * tells whether a slow p95 comes from frame rate (frame time), pipeline depth (frames) or stalls.
+ */
+class FInputLagAttribution
+{
+public:
+	FInputLagAttribution();
+
+	// Add one sample; bTail when it was at or above the p95 when measured
+	void AddSample(float LagMs, float WaitMs, int32 Frames, float FrameTimeMs, float QueueMs, bool bTail);
+
+	// Drop all samples
+	void Reset();
+
+	// Breakdown over all samples / over samples at or above p95
+	FInputLagBreakdown GetAverage() const { return AllSums.GetBreakdown(); }
+	FInputLagBreakdown GetTail() const { return TailSums.GetBreakdown(); }
+
+	bool HasSamples() const { return AllSums.Weight > 0.0; }
+	bool HasTail() const { return TailSums.Weight > 0.0; }
+
+private:
+	// Decaying sums of each part
+	struct FSums
+	{
+		double Weight;
+		double Lag;
+		double Wait;
+		double Frames;
+		double FrameTime;
+		double Queue;
+
+		FSums();
+		void Add(float LagMs, float WaitMs, int32 InFrames, float FrameTimeMs, float QueueMs);
+		FInputLagBreakdown GetBreakdown() const;
+	};
+
+	FSums AllSums;
+	FSums TailSums;
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Core.h"
+#include "InputLagSketch.h"
+#include "InputLagCore/InputLagCoreEventQueue.h"
+
+class AActor;
+class FAudioDevice;
+class USoundBase;
+
+/**
+ * Fire-input-to-audio latency
+ * A fire click hands the weapon's fire sound to a probe that runs on the audio thread once per
+ * game frame. The probe looks through the audio device's active sounds for that sound played by
+ * the shooter (owned by the pawn or weapon, or played near the pawn), so other players firing the
+ * same weapon do not count; once the device has started it, the start time is the probe's time
+ * minus the sound's playback time, and the click-to-start interval goes into its own sketch next
+ * to the visual lag.
+ *
+ * The start is the audio update that started the source (to within one audio update); the
+ * platform mixer's own output buffering comes after it and is not included. Any audio device that
+ * runs its updates works, including OpenAL Soft's null backend on headless Linux.
+ */
+class FInputLagAudioLatency
+{
+public:
+	FInputLagAudioLatency();
+
+	// A fire click at PressTime whose Weapon, held by Shooter, plays Sound; ignored while an earlier click is still waiting
+	void OnFire(USoundBase* Sound, double PressTime, const AActor* Shooter, const AActor* Weapon);
+
+	// Once per game-thread frame: collect what the last probe found and probe again for the waiting click
+	void Tick(FAudioDevice* AudioDevice, double Now);
+
+	// Drop the waiting click and all statistics
+	void Reset();
+
+	// Clicks whose sound was found / not found in time
+	uint64 GetCount() const { return Sketch.GetTotalCount(); }
+	int32 GetMissedCount() const { return MissedCount; }
+
+	// Percentile (0-1) of click to sound start
+	float GetPercentile(float Percentile) const { return Sketch.GetPercentile(Percentile); }
+
+	// One-line summary ("p50 41.3 / p95 52.0 / p99 60.1 ms, 37 shots, 2 missed")
+	FString GetSummaryText() const;
+
+private:
+	// A click's sound found by a probe
+	struct FProbeResult
+	{
+		double PressTime;
+		double StartTime;
+	};
+
+	// Written by the probe on the audio thread, read by the game thread
+	struct FProbeState
+	{
+		InputLagCore::TSpscQueue<FProbeResult, 16> Results;
+
+		// Probes queued on the audio thread and not run yet
+		FThreadSafeCounter InFlight;
+	};
+
+	// Shared with queued probes, which may run after this object is gone
+	TSharedRef<FProbeState, ESPMode::ThreadSafe> ProbeState;
+
+	// Waiting click (Sound is only compared, never dereferenced, on the audio thread)
+	USoundBase* PendingSound;
+	double PendingPressTime;
+
+	// Unique ids of the shooter and weapon, and where the shooter was, for the waiting click
+	uint32 PendingOwnerIDs[2];
+	FVector PendingLocation;
+
+	// Clicks whose sound did not start within the wait
+	int32 MissedCount;
+
+	// Click to sound start
+	FInputLagSketch Sketch;
+};
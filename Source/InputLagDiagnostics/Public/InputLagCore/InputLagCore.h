@@ -0,0 +1,22 @@
+#pragma once
+
+/**
+ * Engine-free input lag measurement core
+ * Header-only, standard library only: builds without the engine for tests, benchmarks and
+ * offline tools. The plugin uses the same pieces for its sessions, sketches and log files.
+ *   InputLagCoreStats.h       weighted percentile/average, min/max over sample arrays
+ *   InputLagCoreRing.h        weighted history ring over caller-owned storage
+ *   InputLagCoreHistogram.h   mergeable log-bucketed latency histogram
+ *   InputLagCoreEventQueue.h  bounded lock-free SPSC event queue
+ *   InputLagCoreTripleBuffer.h lock-free multi-reader latest-snapshot triple buffer
+ *   InputLagCoreEncoding.h    CSV row and compressed log block/index encoders
+ *   InputLagCoreMeasurement.h lag recording step with a time-source parameter
+ */
+
+#include "InputLagCoreStats.h"
+#include "InputLagCoreRing.h"
+#include "InputLagCoreHistogram.h"
+#include "InputLagCoreEventQueue.h"
+#include "InputLagCoreTripleBuffer.h"
+#include "InputLagCoreEncoding.h"
+#include "InputLagCoreMeasurement.h"
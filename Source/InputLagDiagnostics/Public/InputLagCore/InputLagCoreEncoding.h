@@ -0,0 +1,108 @@
+#pragma once
+
+// Engine-free encoders for the session log formats (standard library only)
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+namespace InputLagCore
+{
+	// Compressed log markers ("ILB1" / "ILIX" read as little-endian bytes)
+	const uint32_t LogBlockMagic = 0x31424C49;
+	const uint32_t LogIndexMagic = 0x58494C49;
+
+	// Encoded sizes of the compressed log records
+	const int32_t LogBlockHeaderSize = 12;
+	const int32_t LogIndexEntrySize = 24;
+	const int32_t LogTrailerSize = 16;
+
+	// CSV header row written at the start of every session log file
+	inline const char* GetCsvHeader()
+	{
+		return "Timestamp,FrameNumber,InputLag_ms,InputKey,Phase,QuantWait_ms,LagFrames\n";
+	}
+
+	/** Little-endian writer over a caller-provided buffer */
+	class FLittleEndianWriter
+	{
+	public:
+		explicit FLittleEndianWriter(uint8_t* InBuffer)
+			: Buffer(InBuffer)
+			, Offset(0)
+		{
+		}
+
+		void WriteUInt32(uint32_t Value)
+		{
+			for (int32_t Byte = 0; Byte < 4; ++Byte)
+			{
+				Buffer[Offset++] = (uint8_t)(Value >> (Byte * 8));
+			}
+		}
+
+		void WriteUInt64(uint64_t Value)
+		{
+			for (int32_t Byte = 0; Byte < 8; ++Byte)
+			{
+				Buffer[Offset++] = (uint8_t)(Value >> (Byte * 8));
+			}
+		}
+
+		void WriteDouble(double Value)
+		{
+			uint64_t Bits;
+			std::memcpy(&Bits, &Value, sizeof(Bits));
+			WriteUInt64(Bits);
+		}
+
+		int32_t GetOffset() const { return Offset; }
+
+	private:
+		uint8_t* Buffer;
+		int32_t Offset;
+	};
+
+	// Block header: magic, uncompressed size, compressed size (equal sizes = stored raw). Writes LogBlockHeaderSize bytes.
+	inline int32_t EncodeLogBlockHeader(uint8_t* Out, uint32_t UncompressedSize, uint32_t CompressedSize)
+	{
+		FLittleEndianWriter Writer(Out);
+		Writer.WriteUInt32(LogBlockMagic);
+		Writer.WriteUInt32(UncompressedSize);
+		Writer.WriteUInt32(CompressedSize);
+		return Writer.GetOffset();
+	}
+
+	// Index entry: block file offset, first timestamp (Unix seconds), sizes. Writes LogIndexEntrySize bytes.
+	inline int32_t EncodeLogIndexEntry(uint8_t* Out, int64_t FileOffset, double FirstTimestamp, uint32_t UncompressedSize, uint32_t CompressedSize)
+	{
+		FLittleEndianWriter Writer(Out);
+		Writer.WriteUInt64((uint64_t)FileOffset);
+		Writer.WriteDouble(FirstTimestamp);
+		Writer.WriteUInt32(UncompressedSize);
+		Writer.WriteUInt32(CompressedSize);
+		return Writer.GetOffset();
+	}
+
+	// Trailer: block count, index offset, magic. Writes LogTrailerSize bytes.
+	inline int32_t EncodeLogTrailer(uint8_t* Out, uint32_t NumBlocks, int64_t IndexOffset)
+	{
+		FLittleEndianWriter Writer(Out);
+		Writer.WriteUInt32(NumBlocks);
+		Writer.WriteUInt64((uint64_t)IndexOffset);
+		Writer.WriteUInt32(LogIndexMagic);
+		return Writer.GetOffset();
+	}
+
+	/**
+	 * One CSV row: Timestamp, FrameNumber, InputLag_ms, InputKey, Phase, QuantWait_ms, LagFrames
+	 * Returns the row length, or -1 if it did not fit in BufferSize.
+	 */
+	inline int32_t EncodeCsvRow(char* Buffer, int32_t BufferSize, const char* Timestamp, uint64_t FrameNumber, float LagMs,
+		const char* KeyName, float Phase, float QuantizationWaitMs, uint64_t LagFrames)
+	{
+		int32_t Length = std::snprintf(Buffer, BufferSize, "%s,%llu,%.3f,%s,%.3f,%.3f,%llu\n",
+			Timestamp, (unsigned long long)FrameNumber, LagMs, KeyName, Phase, QuantizationWaitMs, (unsigned long long)LagFrames);
+		return (Length >= 0 && Length < BufferSize) ? Length : -1;
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+// Engine-free single-producer / single-consumer event queue (standard library only)
+
+#include <atomic>
+#include <cstdint>
+
+namespace InputLagCore
+{
+	/**
+	 * Bounded lock-free SPSC queue
+	 * Storage is a fixed array, so pushing never allocates; a full queue rejects the event
+	 * instead of blocking the producer. Capacity must be a power of two.
+	 */
+	template<typename ElementType, uint32_t Capacity>
+	class TSpscQueue
+	{
+		static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+	public:
+		TSpscQueue()
+			: Head(0)
+			, Tail(0)
+		{
+		}
+
+		// Producer: returns false (and drops Element) when the queue is full
+		bool Push(const ElementType& Element)
+		{
+			uint32_t CurrentTail = Tail.load(std::memory_order_relaxed);
+			if (CurrentTail - Head.load(std::memory_order_acquire) >= Capacity)
+			{
+				return false;
+			}
+			Elements[CurrentTail & (Capacity - 1)] = Element;
+			Tail.store(CurrentTail + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Consumer: returns false when empty
+		bool Pop(ElementType& OutElement)
+		{
+			uint32_t CurrentHead = Head.load(std::memory_order_relaxed);
+			if (CurrentHead == Tail.load(std::memory_order_acquire))
+			{
+				return false;
+			}
+			OutElement = Elements[CurrentHead & (Capacity - 1)];
+			Head.store(CurrentHead + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Approximate number of queued events (exact when called from either end while the other is idle)
+		uint32_t Num() const
+		{
+			return Tail.load(std::memory_order_acquire) - Head.load(std::memory_order_acquire);
+		}
+
+	private:
+		ElementType Elements[Capacity];
+
+		// Consumer and producer positions on separate cache lines
+		alignas(64) std::atomic<uint32_t> Head;
+		alignas(64) std::atomic<uint32_t> Tail;
+	};
+}
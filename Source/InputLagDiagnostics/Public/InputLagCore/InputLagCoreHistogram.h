@@ -0,0 +1,130 @@
+#pragma once
+
+// Engine-free mergeable log-bucketed latency histogram (standard library only)
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace InputLagCore
+{
+	/**
+	 * Log-bucketed lag histogram with a fixed layout, so histograms merge by adding counts
+	 * Bucket 0 holds lags below GetMinLagMs(), the last bucket lags at or above GetMaxLagMs(),
+	 * the NumBuckets - 2 buckets in between grow geometrically.
+	 */
+	template<int32_t NumBuckets>
+	class TLogHistogram
+	{
+		static_assert(NumBuckets > 2, "Need room for the under/overflow buckets");
+
+	public:
+		TLogHistogram()
+		{
+			Reset();
+		}
+
+		static float GetMinLagMs() { return 0.5f; }
+		static float GetMaxLagMs() { return 1000.0f; }
+
+		void Add(float LagMs, uint64_t Weight = 1)
+		{
+			Counts[GetBucket(LagMs)] += Weight;
+			TotalCount += Weight;
+		}
+
+		void AddToBucket(int32_t Bucket, uint64_t Count)
+		{
+			Counts[Bucket] += Count;
+			TotalCount += Count;
+		}
+
+		// Remove up to MaxCount from a bucket; returns how much was taken
+		uint64_t TakeFromBucket(int32_t Bucket, uint64_t MaxCount)
+		{
+			uint64_t Taken = std::min(Counts[Bucket], MaxCount);
+			Counts[Bucket] -= Taken;
+			TotalCount -= Taken;
+			return Taken;
+		}
+
+		void Merge(const TLogHistogram& Other)
+		{
+			for (int32_t Bucket = 0; Bucket < NumBuckets; ++Bucket)
+			{
+				Counts[Bucket] += Other.Counts[Bucket];
+			}
+			TotalCount += Other.TotalCount;
+		}
+
+		void Reset()
+		{
+			std::memset(Counts, 0, sizeof(Counts));
+			TotalCount = 0;
+		}
+
+		uint64_t GetCount(int32_t Bucket) const { return Counts[Bucket]; }
+		uint64_t GetTotalCount() const { return TotalCount; }
+
+		// Representative lag of the first bucket whose cumulative count reaches Percentile (0 when empty)
+		float GetPercentile(float Percentile) const
+		{
+			if (TotalCount == 0)
+			{
+				return 0.0f;
+			}
+
+			double Target = (double)TotalCount * Percentile;
+			uint64_t Cumulative = 0;
+			for (int32_t Bucket = 0; Bucket < NumBuckets; ++Bucket)
+			{
+				Cumulative += Counts[Bucket];
+				if (Counts[Bucket] > 0 && (double)Cumulative >= Target)
+				{
+					return GetBucketValue(Bucket);
+				}
+			}
+			return GetBucketValue(NumBuckets - 1);
+		}
+
+		static int32_t GetBucket(float LagMs)
+		{
+			if (!(LagMs >= GetMinLagMs()))
+			{
+				return 0;
+			}
+			if (LagMs >= GetMaxLagMs())
+			{
+				return NumBuckets - 1;
+			}
+
+			int32_t LogBucket = (int32_t)std::floor(std::log(LagMs / GetMinLagMs()) / GetLogBucketRatio());
+			return std::min(std::max(1 + LogBucket, 1), NumBuckets - 2);
+		}
+
+		// Geometric midpoint of a bucket
+		static float GetBucketValue(int32_t Bucket)
+		{
+			if (Bucket <= 0)
+			{
+				return GetMinLagMs() * 0.5f;
+			}
+			if (Bucket >= NumBuckets - 1)
+			{
+				return GetMaxLagMs();
+			}
+			return GetMinLagMs() * std::exp((Bucket - 1 + 0.5f) * GetLogBucketRatio());
+		}
+
+	private:
+		// Log of the growth factor between neighbouring log buckets
+		static float GetLogBucketRatio()
+		{
+			return std::log(GetMaxLagMs() / GetMinLagMs()) / (NumBuckets - 2);
+		}
+
+		uint64_t Counts[NumBuckets];
+		uint64_t TotalCount;
+	};
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+// Engine-free input lag measurement pipeline (standard library only)
+
+#include <chrono>
+#include <cstdint>
+
+#include "InputLagCoreRing.h"
+
+namespace InputLagCore
+{
+	/** Default time source: monotonic seconds from std::chrono::steady_clock */
+	struct FSteadyClockTimeSource
+	{
+		static double Now()
+		{
+			return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+	};
+
+	// Samples outside (0, MaxPlausibleLagMs) are discarded as measurement errors
+	inline bool IsPlausibleLag(float LagMs)
+	{
+		return LagMs > 0.0f && LagMs < 1000.0f;
+	}
+
+	// Exponential moving average used for the "Smoothed" value (first sample seeds it)
+	inline float SmoothLag(float Previous, float Sample)
+	{
+		return (Previous == 0.0f) ? Sample : 0.9f * Previous + 0.1f * Sample;
+	}
+
+	// Where an input arrived within its frame (0 = start, 1 = end); -1 if the frame bounds are unknown
+	inline float GetArrivalPhase(double ArrivalTime, double FrameStart, double FrameEnd)
+	{
+		double Duration = FrameEnd - FrameStart;
+		if (FrameStart <= 0.0 || Duration <= 0.0)
+		{
+			return -1.0f;
+		}
+		double Phase = (ArrivalTime - FrameStart) / Duration;
+		return (float)(Phase < 0.0 ? 0.0 : (Phase > 1.0 ? 1.0 : Phase));
+	}
+
+	/**
+	 * Close a pending measurement at the display point, by TimeSourceType's clock (a type with
+	 * static double Now() in seconds, so tests and benchmarks can drive it with a fake clock and
+	 * the engine with FPlatformTime). A plausible sample updates the raw and smoothed lag and is
+	 * pushed with Weight into the history ring; returns the lag in ms, or -1 if it was discarded.
+	 * OutNow is the time the measurement was closed at.
+	 */
+	template<typename TimeSourceType>
+	float RecordLag(double ArrivalTime, float Weight, float* History, float* Weights, int32_t& HistoryIndex, int32_t Capacity,
+		float& RawLagMs, float& SmoothedLagMs, double& OutNow)
+	{
+		OutNow = TimeSourceType::Now();
+		float LagMs = (float)((OutNow - ArrivalTime) * 1000.0);
+		if (!IsPlausibleLag(LagMs))
+		{
+			return -1.0f;
+		}
+
+		RawLagMs = LagMs;
+		SmoothedLagMs = SmoothLag(SmoothedLagMs, LagMs);
+		RingPush(History, Weights, HistoryIndex, Capacity, LagMs, Weight);
+		return LagMs;
+	}
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+// Engine-free lag history ring over caller-owned storage (standard library only)
+
+#include <cstdint>
+
+namespace InputLagCore
+{
+	/** Write a sample and its weight at Index of a ring and advance Index (works on any ring storage, e.g. one row of a table) */
+	inline void RingPush(float* Values, float* Weights, int32_t& Index, int32_t Capacity, float Value, float Weight)
+	{
+		Values[Index] = Value;
+		Weights[Index] = Weight;
+		Index = (Index + 1) % Capacity;
+	}
+
+	/** Most recently written value of a ring */
+	inline float RingLast(const float* Values, int32_t Index, int32_t Capacity)
+	{
+		return Values[(Index - 1 + Capacity) % Capacity];
+	}
+}
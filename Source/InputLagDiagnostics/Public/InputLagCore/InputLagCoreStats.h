@@ -0,0 +1,101 @@
+#pragma once
+
+// Engine-free statistics over lag sample arrays (standard library only)
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace InputLagCore
+{
+	/**
+	 * Weighted percentile over parallel value/weight arrays
+	 * Values <= 0 are empty slots, null Weights count 1 each. Returns the first sample (in
+	 * value order) whose cumulative weight reaches Percentile of the total; with equal weights
+	 * this is the ceil(N * p) - 1 index.
+	 */
+	inline float WeightedPercentile(const float* Values, const float* Weights, int32_t Num, float Percentile)
+	{
+		std::vector<std::pair<float, float>> Samples;
+		Samples.reserve(Num > 0 ? Num : 0);
+
+		float TotalWeight = 0.0f;
+		for (int32_t Index = 0; Index < Num; ++Index)
+		{
+			if (Values[Index] > 0.0f)
+			{
+				float Weight = Weights ? Weights[Index] : 1.0f;
+				Samples.push_back(std::make_pair(Values[Index], Weight));
+				TotalWeight += Weight;
+			}
+		}
+
+		if (Samples.empty() || TotalWeight <= 0.0f)
+		{
+			return 0.0f;
+		}
+
+		std::sort(Samples.begin(), Samples.end(), [](const std::pair<float, float>& A, const std::pair<float, float>& B)
+		{
+			return A.first < B.first;
+		});
+
+		float Target = TotalWeight * Percentile;
+		float Cumulative = 0.0f;
+		for (const std::pair<float, float>& Sample : Samples)
+		{
+			Cumulative += Sample.second;
+			if (Cumulative >= Target)
+			{
+				return Sample.first;
+			}
+		}
+
+		return Samples.back().first;
+	}
+
+	/** Weighted mean over parallel value/weight arrays (values <= 0 are empty slots, null Weights count 1 each) */
+	inline float WeightedAverage(const float* Values, const float* Weights, int32_t Num)
+	{
+		double Sum = 0.0;
+		double TotalWeight = 0.0;
+
+		for (int32_t Index = 0; Index < Num; ++Index)
+		{
+			if (Values[Index] > 0.0f)
+			{
+				double Weight = Weights ? Weights[Index] : 1.0;
+				Sum += Values[Index] * Weight;
+				TotalWeight += Weight;
+			}
+		}
+
+		return (TotalWeight > 0.0) ? (float)(Sum / TotalWeight) : 0.0f;
+	}
+
+	/** Smallest non-empty value (0 when all slots are empty) */
+	inline float MinValue(const float* Values, int32_t Num)
+	{
+		float MinLag = 0.0f;
+		for (int32_t Index = 0; Index < Num; ++Index)
+		{
+			if (Values[Index] > 0.0f && (MinLag == 0.0f || Values[Index] < MinLag))
+			{
+				MinLag = Values[Index];
+			}
+		}
+		return MinLag;
+	}
+
+	/** Largest value (0 when all slots are empty) */
+	inline float MaxValue(const float* Values, int32_t Num)
+	{
+		float MaxLag = 0.0f;
+		for (int32_t Index = 0; Index < Num; ++Index)
+		{
+			MaxLag = std::max(MaxLag, Values[Index]);
+		}
+		return MaxLag;
+	}
+}
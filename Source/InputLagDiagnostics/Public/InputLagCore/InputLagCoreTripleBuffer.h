@@ -0,0 +1,121 @@
+#pragma once
+
+// Engine-free lock-free triple buffer (standard library only)
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+namespace InputLagCore
+{
+	/**
+	 * Single-producer / multi-reader triple buffer for publishing snapshots
+	 * The producer fills a private write buffer and publishes it into the next of three versioned
+	 * slots, then points the readers at that slot. Any number of readers on any thread copy the
+	 * latest slot out and check its version did not change while they copied, so a reader never
+	 * sees a torn snapshot and nobody ever takes a lock. A reader only has to copy again if the
+	 * producer came round to its slot again (three more publishes) in the middle of its copy.
+	 *
+	 * Slots are stored as relaxed atomic words, so concurrent copies are well-defined; the element
+	 * type has to be trivially copyable.
+	 */
+	template<typename ElementType>
+	class TTripleBuffer
+	{
+	public:
+		TTripleBuffer()
+			: LatestIndex(0)
+			, WriteBuffer()
+			, PublishedBuffer()
+		{
+			for (int32_t Index = 0; Index < NumSlots; ++Index)
+			{
+				Versions[Index].store(0, std::memory_order_relaxed);
+				StoreSlot(Index, WriteBuffer);
+			}
+		}
+
+		// Producer: buffer to fill before Publish (holds what was published last)
+		ElementType& GetWriteBuffer()
+		{
+			return WriteBuffer;
+		}
+
+		// Producer: make the write buffer the latest snapshot
+		void Publish()
+		{
+			uint32_t Index = (LatestIndex.load(std::memory_order_relaxed) + 1) % NumSlots;
+
+			// Odd while the slot is rewritten, so readers still copying it from three publishes ago retry
+			uint32_t Version = Versions[Index].load(std::memory_order_relaxed);
+			Versions[Index].store(Version + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			StoreSlot(Index, WriteBuffer);
+			Versions[Index].store(Version + 2, std::memory_order_release);
+
+			LatestIndex.store(Index, std::memory_order_release);
+			PublishedBuffer = WriteBuffer;
+		}
+
+		// Producer: the last published snapshot
+		const ElementType& GetPublished() const
+		{
+			return PublishedBuffer;
+		}
+
+		// Any thread: a copy of the latest published snapshot
+		ElementType Read() const
+		{
+			ElementType Snapshot;
+			for (;;)
+			{
+				uint32_t Index = LatestIndex.load(std::memory_order_acquire);
+				uint32_t Version = Versions[Index].load(std::memory_order_acquire);
+				if ((Version & 1) == 0)
+				{
+					LoadSlot(Index, Snapshot);
+					std::atomic_thread_fence(std::memory_order_acquire);
+					if (Versions[Index].load(std::memory_order_relaxed) == Version)
+					{
+						return Snapshot;
+					}
+				}
+			}
+		}
+
+	private:
+		static const int32_t NumSlots = 3;
+		static const int32_t NumWords = (int32_t)((sizeof(ElementType) + sizeof(uint32_t) - 1) / sizeof(uint32_t));
+
+		void StoreSlot(int32_t Index, const ElementType& Element)
+		{
+			uint32_t Words[NumWords] = {};
+			std::memcpy(Words, &Element, sizeof(ElementType));
+			for (int32_t Word = 0; Word < NumWords; ++Word)
+			{
+				Slots[Index][Word].store(Words[Word], std::memory_order_relaxed);
+			}
+		}
+
+		void LoadSlot(int32_t Index, ElementType& OutElement) const
+		{
+			uint32_t Words[NumWords];
+			for (int32_t Word = 0; Word < NumWords; ++Word)
+			{
+				Words[Word] = Slots[Index][Word].load(std::memory_order_relaxed);
+			}
+			std::memcpy(&OutElement, Words, sizeof(ElementType));
+		}
+
+		// Published slots and their versions (even = stable)
+		std::atomic<uint32_t> Slots[NumSlots][NumWords];
+		std::atomic<uint32_t> Versions[NumSlots];
+
+		// Slot readers copy from
+		alignas(64) std::atomic<uint32_t> LatestIndex;
+
+		// Producer-side buffers
+		alignas(64) ElementType WriteBuffer;
+		ElementType PublishedBuffer;
+	};
+}
@@ -2,9 +2,28 @@
 
 #include "ModuleManager.h"
 
+class FInputLagMeasurementService;
+
 class FInputLagDiagnosticsModule : public IModuleInterface
 {
 public:
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
+
+	// Loaded module instance (cached at startup: the mutator reaches it several times per frame)
+	static FInputLagDiagnosticsModule& Get()
+	{
+		check(Instance);
+		return *Instance;
+	}
+
+	// Measurement service shared by the mutator, player controller and HUD (valid between startup and shutdown)
+	FInputLagMeasurementService* GetService() const { return Service.Get(); }
+
+private:
+	// This module, set by StartupModule and kept until the module is destroyed (GetService is null after shutdown)
+	static FInputLagDiagnosticsModule* Instance;
+
+	// Owns every measurement session so they persist across map travel
+	TUniquePtr<FInputLagMeasurementService> Service;
 };
@@ -4,10 +4,13 @@
 #include "Engine.h"
 #include "UnrealTournament.h"
 #include "UTMutator.h"
+#include "InputLagMeasurementService.h"
+#include "InputLagSketch.h"
 #include "InputLagDiagnosticsMutator.generated.h"
 
-// Forward declaration
-class FInputLagDiagnostics;
+// Forward declarations
+class FInputLagInputProcessor;
+class AInputLagReporter;
 
 UCLASS(Blueprintable, Meta = (ChildCanTick))
 class AInputLagDiagnosticsMutator : public AUTMutator
@@ -19,17 +22,91 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Input Lag")
 	bool bAutoEnableForAllPlayers;
 
-	// Reference to our InputLag diagnostics helper (plain C++ class)
-	FInputLagDiagnostics* InputLagDiagnostics;
+	// Handles to the module-owned measurement sessions, one per local player slot
+	FInputLagSessionHandle SessionHandles[FInputLagMeasurementService::MaxSessions];
+
+	// Local controller bound to each slot (indexed by slot)
+	UPROPERTY(Transient)
+	TArray<APlayerController*> BoundControllers;
+
+	// Slate preprocessor delivering raw mouse movement as it is pumped (feeds the primary local player)
+	TSharedPtr<FInputLagInputProcessor> InputProcessor;
+
+	// Non-blocking input components pushed on top of each local player's input stack for mouse button presses (indexed by slot)
+	UPROPERTY(Transient)
+	TArray<UInputComponent*> InputLagInputComponents;
 
 	virtual void Init_Implementation(const FString& Options) override;
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void Tick(float DeltaTime) override;
 	virtual void ModifyPlayer_Implementation(APawn* Other, bool bIsNewSpawn) override;
+
+	// Server: log the match report when the match ends
+	virtual void NotifyMatchStateChange_Implementation(FName NewState) override;
+
+	// Server: a player scored damage - confirm their latest tagged fire click
+	virtual void ScoreDamage_Implementation(int32 DamageAmount, AUTPlayerState* Victim, AUTPlayerState* Attacker) override;
 	
 	// Mutate command handler (called via "mutate showinputlag")
 	virtual void Mutate_Implementation(const FString& MutateString, APlayerController* Sender) override;
 	
 	// PostRenderFor callback for HUD drawing (called by AHUD::DrawActorOverlays)
 	virtual void PostRenderFor(APlayerController* PC, UCanvas* Canvas, FVector CameraPosition, FVector CameraDir) override;
+
+	// Server: one latency reporter per player controller
+	UPROPERTY(Transient)
+	TArray<AInputLagReporter*> Reporters;
+
+	// Server: sketches merged from client reports, per player name and for the whole match
+	TMap<FString, FInputLagSketch> PlayerSketches;
+	FInputLagSketch MatchSketch;
+
+	// Server: merge a client's report (called by its AInputLagReporter)
+	void ReceiveSketch(APlayerController* PC, const TArray<uint16>& Counts);
+
+	// Session for a local player slot, or for the slot a controller occupies (nullptr if not attached)
+	FInputLagDiagnostics* GetSession(int32 Slot) const;
+	FInputLagDiagnostics* GetSessionFor(APlayerController* PC) const;
+
+protected:
+	// Attach a local player to the session for its slot, hook its input events and HUD
+	void SetPlayerOwner(APlayerController* PC);
+
+	// Bind every local player that does not have a session owner yet
+	void BindLocalPlayers();
+
+	// Register or drop the tick, HUD post-render and input hooks for a slot to match whether its
+	// session is enabled, so a disabled session costs nothing per frame
+	void RefreshPlayerHooks(int32 Slot);
+
+	// RefreshPlayerHooks for every slot (bound to each session's OnEnabledChanged)
+	void RefreshAllPlayerHooks();
+
+	// Register the input preprocessor (primary player only) and push the input component onto the owner's stack
+	void BindInputCapture(APlayerController* PC, int32 Slot);
+
+	// Undo BindInputCapture for one slot
+	void UnbindInputCapture(int32 Slot);
+
+	// Mouse button handler bound on each player's input component, with that player's slot
+	void RecordButtonPress(FKey Key, int32 Slot);
+
+	// Server: spawn the reporter for a controller if it has none yet
+	void EnsureReporter(APlayerController* PC);
+
+	// Server: match-wide and per-player percentile lines for "mutate inputlag report" and the match-end log
+	void GetLatencyReport(TArray<FString>& OutLines) const;
+
+	// Server: write the latency report to the log, once per match
+	void LogMatchReport();
+
+	// Server: the match report has been logged
+	bool bMatchReportLogged;
+
+	// Subscriptions to each session's OnEnabledChanged (sessions outlive the mutator)
+	FDelegateHandle EnabledChangedHandles[FInputLagMeasurementService::MaxSessions];
+
+	// Periodic BindLocalPlayers for players and HUDs that appear after BeginPlay
+	FTimerHandle BindPlayersTimerHandle;
 };
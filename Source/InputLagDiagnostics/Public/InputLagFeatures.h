@@ -0,0 +1,54 @@
+#pragma once
+
+// Compile-time feature switches, defined by InputLagDiagnostics.Build.cs (1 = compiled in, 0 = stripped).
+// The fallbacks keep the header usable from tools that build the sources without the module rules.
+#ifndef INPUTLAG_WITH_LOGGING
+#define INPUTLAG_WITH_LOGGING 1
+#endif
+
+#ifndef INPUTLAG_WITH_PERCENTILES
+#define INPUTLAG_WITH_PERCENTILES 1
+#endif
+
+#ifndef INPUTLAG_WITH_HUD
+#define INPUTLAG_WITH_HUD 1
+#endif
+
+#ifndef INPUTLAG_WITH_STAGE_TIMING
+#define INPUTLAG_WITH_STAGE_TIMING 1
+#endif
+
+#ifndef INPUTLAG_WITH_HIT_CONFIRM
+#define INPUTLAG_WITH_HIT_CONFIRM 1
+#endif
+
+#ifndef INPUTLAG_WITH_AUDIO_LATENCY
+#define INPUTLAG_WITH_AUDIO_LATENCY 1
+#endif
+
+/**
+ * Compile-time feature policy
+ * Call sites test these constants in plain if statements instead of wrapping code in #if, so
+ * stripped features still compile (and cannot rot) but the optimizer removes them entirely.
+ * With a feature stripped its commands report that it is not available in this build.
+ */
+struct FInputLagFeatures
+{
+	// CSV session logs (FInputLagLogWriter)
+	static constexpr bool bLogging = INPUTLAG_WITH_LOGGING != 0;
+
+	// Percentile statistics, server report sketches and the pacing / late-latch comparisons
+	static constexpr bool bPercentiles = INPUTLAG_WITH_PERCENTILES != 0;
+
+	// On-screen overlay (measurements still finalize in the post-render callback)
+	static constexpr bool bHUD = INPUTLAG_WITH_HUD != 0;
+
+	// Per-stage timing: input arrival phase analysis and the Chrome trace export
+	static constexpr bool bStageTiming = INPUTLAG_WITH_STAGE_TIMING != 0;
+
+	// Fire click tagging and click-to-hit-confirmation timing
+	static constexpr bool bHitConfirm = INPUTLAG_WITH_HIT_CONFIRM != 0;
+
+	// Fire click to fire sound start timing (audio-thread probe)
+	static constexpr bool bAudioLatency = INPUTLAG_WITH_AUDIO_LATENCY != 0;
+};
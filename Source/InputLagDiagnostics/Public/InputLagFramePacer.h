@@ -0,0 +1,110 @@
+#pragma once
+
+#include "Core.h"
+#include "InputLagSketch.h"
+
+/**
+ * Latency-aware frame pacer (just-in-time input sampling)
+ * Replaces the engine's frame rate limiter while enabled. The engine limiter (t.MaxFPS) only
+ * spaces frame starts; when the render thread or GPU cannot keep up with the cap, the game
+ * thread samples input and then blocks on the frames queued ahead of it, so every input pays
+ * for that queue. The pacer instead sleeps at the start of the frame - before the message pump
+ * reads input - until the latest moment that still lets the game thread finish by the next
+ * frame deadline. The deadline interval is the cap, stretched to the measured render thread /
+ * GPU time so no queue builds up, and the wake-up time uses the measured game thread work
+ * plus an adaptive safety margin that grows on missed deadlines.
+ *
+ * Lag measured by every session is split into "before" (pacer off) and "while pacing"
+ * sketches, so the reduction reported on the HUD and in the log comes from the plugin's own
+ * measurements.
+ */
+class FInputLagFramePacer
+{
+public:
+	FInputLagFramePacer();
+
+	// Start pacing to TargetFPS (0 = use the current t.MaxFPS); returns false if there is no cap to pace to
+	bool Enable(float InTargetFPS);
+
+	// Stop pacing, restore the engine limiter and log the lag comparison
+	void Disable();
+
+	// True while the pacer owns the frame rate limit
+	bool IsEnabled() const { return bEnabled; }
+
+	// Called at the start of every frame, before input is pumped; sleeps until the wake-up time
+	void OnBeginFrame();
+
+	// Called at the end of every frame to detect missed deadlines
+	void OnEndFrame();
+
+	// Feed one completed lag measurement (from any session)
+	void AddLagSample(float LagMs, uint32 Weight);
+
+	// Lag percentile (0-1) measured without / with pacing; 0 when there are no samples
+	float GetBaselinePercentile(float Percentile) const { return BaselineSketch.GetPercentile(Percentile); }
+	float GetPacedPercentile(float Percentile) const { return PacedSketch.GetPercentile(Percentile); }
+
+	// True once both sketches hold enough samples for a comparison
+	bool HasComparison() const;
+
+	// One-line status for the HUD
+	FString GetStatusText() const;
+
+	// One-line p95 comparison ("p95 28.1 -> 19.4 ms (-31%)"), empty without enough samples
+	FString GetComparisonText() const;
+
+private:
+	// Sleep coarsely, then yield-spin the last stretch for sub-millisecond wake-up accuracy
+	static void WaitUntil(double WakeTime);
+
+	// Console variable helpers
+	static FString GetConsoleVariable(const TCHAR* Name);
+	static void SetConsoleVariable(const TCHAR* Name, const FString& Value);
+
+	// Seconds for an engine stat cycle count (GGameThreadTime, GRenderThreadTime, GGPUFrameTime)
+	static double CyclesToSeconds(uint32 Cycles);
+
+	// Minimum samples per sketch before a comparison is shown
+	static const uint64 MinComparisonSamples = 20;
+
+	// Whether the pacer is active
+	bool bEnabled;
+
+	// Requested frame rate
+	float TargetFPS;
+
+	// Interval between frame deadlines used for the current frame
+	double TargetPeriod;
+
+	// Time by which the current frame's game thread work should be done (0 = resync on next frame)
+	double FrameDeadline;
+
+	// Smoothed game thread work and its mean deviation, in seconds
+	double SmoothedWork;
+	double WorkDeviation;
+
+	// Smoothed render thread / GPU frame time, whichever is slower, in seconds
+	double SmoothedBottleneck;
+
+	// Extra time kept in reserve before the deadline; doubled on a miss, decays while on time
+	double SafetyMargin;
+
+	// Time the game thread woke up for the current frame (0 = not paced yet)
+	double WakeTime;
+
+	// Time slept at the start of the last frame
+	double LastSleepSeconds;
+
+	// Frames paced and deadlines missed since enabling
+	int32 PacedFrames;
+	int32 MissedDeadlines;
+
+	// Lag measured while the pacer was off (reset each time pacing stops) and while it was on
+	FInputLagSketch BaselineSketch;
+	FInputLagSketch PacedSketch;
+
+	// Settings to restore once pacing stops
+	FString OriginalMaxFPS;
+	bool bOriginalSmoothFrameRate;
+};
@@ -2,19 +2,114 @@
 
 #include "Core.h"
 #include "Engine.h"
+#include "InputLagSampler.h"
+#include "InputLagSweep.h"
+#include "InputLagPlayerTable.h"
+#include "InputLagTrace.h"
+#include "InputLagSketch.h"
+#include "InputLagPollingAnalyzer.h"
+#include "InputLagHitConfirm.h"
+#include "InputLagAudioLatency.h"
+#include "InputLagAttribution.h"
+#include "InputLagPipelineDepth.h"
+#include "InputLagInputRecording.h"
+#include "InputLagCore/InputLagCoreTripleBuffer.h"
+
+class FInputLagFramePacer;
+class FInputLagLateLatch;
+
+// A fire click was tagged for hit-confirmation timing
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnInputLagFireTagged, uint16);
+
+/** Session statistics as of the last published frame (plain values, safe to copy to any thread) */
+struct FInputLagStatsSnapshot
+{
+	// Frame the snapshot was published in (0 = nothing published yet)
+	uint64 FrameNumber;
+
+	// Samples measured by the session so far
+	uint32 SampleCount;
+
+	float AverageLag;
+	float LastLag;
+	float MinLag;
+	float MaxLag;
+	float Percentile95Lag;
+	float SmoothedLag;
+	float RawLag;
+
+	// Sampling mode the averages were computed under
+	EInputLagSamplingMode SamplingMode;
+
+	FInputLagStatsSnapshot()
+		: FrameNumber(0)
+		, SampleCount(0)
+		, AverageLag(0.0f)
+		, LastLag(0.0f)
+		, MinLag(0.0f)
+		, MaxLag(0.0f)
+		, Percentile95Lag(0.0f)
+		, SmoothedLag(0.0f)
+		, RawLag(0.0f)
+		, SamplingMode(EInputLagSamplingMode::Auto)
+	{
+	}
+};
+
+/** Measured sample waiting for the render thread to get through the frame it was measured in */
+struct FInputLagRenderSample
+{
+	// Render stamp queued behind the measured frame
+	uint32 StampSequence;
+
+	// Frame the input arrived in, frame and wall-clock time it was measured at
+	uint64 InputFrame;
+	uint64 MeasuredFrame;
+	FDateTime MeasuredAt;
+
+	// Measured lag, input and arrival phase / frame-quantization wait (-1 / 0 when unknown)
+	float LagMs;
+	FKey Key;
+	float Phase;
+	float QuantizationWaitMs;
+
+	// Input arrival time, frame time when measured, and whether the lag was at or above the p95 then
+	double InputTime;
+	float FrameTimeMs;
+	bool bTail;
+
+	FInputLagRenderSample()
+		: StampSequence(0)
+		, InputFrame(0)
+		, MeasuredFrame(0)
+		, LagMs(0.0f)
+		, Phase(-1.0f)
+		, QuantizationWaitMs(0.0f)
+		, InputTime(0.0)
+		, FrameTimeMs(0.0f)
+		, bTail(false)
+	{
+	}
+};
 
 /**
  * Helper class for input lag diagnostics rendering
  * This is a simple C++ class, not a UObject, to avoid any ABI issues with UT HUD inheritance
+ * Instances are measurement sessions owned by FInputLagMeasurementService and persist across map travel
+ * Per-input hot state (pending input, lag ring) lives in the service's FInputLagPlayerTable row for this session
  */
 class FInputLagDiagnostics
 {
 public:
 	FInputLagDiagnostics();
+	~FInputLagDiagnostics();
 	
-	// Toggle for showing input lag diagnostics
+	// Toggle for showing input lag diagnostics; also the master switch for measuring (change with SetEnabled)
 	bool bShowInputLagDiagnostics;
 
+	// Fired when bShowInputLagDiagnostics changes, so owners can add or drop their per-frame hooks
+	FSimpleMulticastDelegate OnEnabledChanged;
+
 	// Toggle for CSV logging
 	bool bEnableCSVLogging;
 
@@ -24,39 +119,165 @@ public:
 	// Canvas for drawing (borrowed from actual HUD)
 	UCanvas* Canvas;
 
-	// Last recorded input timestamp
-	double LastInputTimestamp;
+	// Shared per-player state owned by the service, and this session's row in it
+	FInputLagPlayerTable* Players;
+	int32 Slot;
+
+	// Process-wide frame pacer owned by the service (fed with this session's lag samples)
+	FInputLagFramePacer* FramePacer;
+
+	// Render-thread late latching of mouse look (primary player only, null for other sessions)
+	TSharedPtr<FInputLagLateLatch, ESPMode::ThreadSafe> LateLatch;
+
+	// Mouse-look lag with late latching (input to the render thread applying it) and without
+	// (input to the end of the game-thread frame), collected from the same samples
+	FInputLagSketch LatchedLagSketch;
+	FInputLagSketch UnlatchedLagSketch;
+
+	// Mouse polling rate, delivery jitter and per-frame batching of raw events
+	FInputLagPollingAnalyzer Polling;
+
+	// Click-to-hit-confirmation latency and its local / network / server segments
+	FInputLagHitConfirm HitConfirm;
+
+	// Each sample's lag to render-thread completion split into frame wait, pipelined frames x frame time, queueing and other
+	FInputLagAttribution Attribution;
+
+	// Frames from input until the render thread finished its frame: session histogram and detected depth
+	FInputLagPipelineDepth PipelineDepth;
+
+	// Render-thread completion of measured frames, and the samples waiting on it (oldest first)
+	FInputLagRenderStamps RenderStamps;
+	TArray<FInputLagRenderSample> RenderSamples;
 
-	// Frame number when the input was recorded
-	uint64 InputFrameNumber;
+	// How long the HUD flags a pipeline depth change
+	static const int32 PipelineDepthFlagSeconds = 10;
 
-	// Last tracked input key name
-	FKey LastTrackedInputKey;
+	// Fire click to the audio device starting the weapon's fire sound
+	FInputLagAudioLatency AudioLatency;
 
-	// Whether we're waiting to measure input lag
-	bool bPendingInputMeasurement;
+	// Fired for every tagged fire click (the owner's AInputLagReporter sends the tag to the server)
+	FOnInputLagFireTagged OnFireTagged;
 
-	// History of input lag measurements (in milliseconds) - circular buffer
-	TArray<float> InputLagHistory;
+	// Raw input recorder and replayer (events come from AInputLagPlayerController)
+	FInputLagInputRecording Recording;
 
-	// Current index in the circular buffer
-	int32 HistoryIndex;
+	// Sampling policy in front of input recording (every-Nth, stride, reservoir, auto)
+	FInputLagSampler Sampler;
 
-	// Smoothed input lag value (exponential moving average)
-	float SmoothedInputLag;
+	// Frame-pacing settings sweep benchmark
+	FInputLagSweep Sweep;
 
-	// Raw (unsmoothed) input lag from last measurement
-	float RawInputLag;
+	// Chrome trace timeline export of frames and tracked inputs
+	FInputLagTrace Trace;
+
+	// Samples collected since the last server report (drained by AInputLagReporter)
+	FInputLagSketch ReportSketch;
+
+	// Close mouse-look measurements only once the camera's final view rotation reflects the input
+	bool bVerifyCameraRotation;
+
+	// Camera view rotation at the moment the pending mouse input arrived
+	FRotator InputCameraRotation;
+
+	// Smallest camera rotation change (degrees) that counts as the input being visible
+	float MinVerifiedRotationDegrees;
+
+	// Camera degrees per unit of mouse axis delta, fitted from verified samples (decayed least
+	// squares: degrees x delta, delta squared); index 0 is MouseX/yaw, 1 is MouseY/pitch
+	double VerifySumXY[2];
+	double VerifySumXX[2];
 
 	// Maximum number of samples to keep
-	static const int32 MaxInputLagSamples = 200;
+	static const int32 MaxInputLagSamples = FInputLagPlayerTable::HistoryCapacity;
+
+	// Frames to wait for the camera to react before a verified measurement is dropped
+	static const int32 MaxVerifiedCameraFrames = 60;
+
+	// Where in its frame the last measured input arrived (0 = frame start, 1 = frame end, -1 = unknown)
+	float LastInputPhase;
+
+	// Time the last measured input spent waiting for its frame to end, in milliseconds
+	float LastQuantizationWaitMs;
+
+	// Number of equal-width phase bins for lag-vs-phase statistics
+	static const int32 NumPhaseBins = 10;
+
+	// Per phase bin: sample count, summed lag and summed frame-quantization wait (ms)
+	TArray<int32> PhaseBinCounts;
+	TArray<double> PhaseBinLagSum;
+	TArray<double> PhaseBinWaitSum;
 	
-	// Tick function for input tracking (called by mutator)
+	// Point this session at its row in the shared player table (done once by the service)
+	void BindPlayerSlot(FInputLagPlayerTable* InPlayers, int32 InSlot);
+
+	// Player table row index of this session
+	int32 GetPlayerSlot() const { return Slot; }
+
+	// Per-frame bookkeeping (called by mutator); input itself arrives through OnInputKey/OnInputAxis
 	void Tick(float DeltaTime);
 
+	// Input event entry points, called by the mutator's input hooks as events arrive
+	void OnInputKey(FKey Key, EInputEvent EventType);
+	void OnInputAxis(FKey Key, float Delta);
+
+	// Raw mouse movement from the Slate preprocessor (Y grows upwards), forwarded to late latching
+	void OnRawMouseDelta(const FVector2D& Delta);
+
+	// Mouse InputAxis call from the player controller with the number of raw events coalesced into it
+	void OnInputAxisSamples(FKey Key, int32 NumSamples);
+
+	// Turn measuring and the overlay on or off (drops the pending measurement when turned off)
+	void SetEnabled(bool bInEnabled);
+
 	// Toggle input lag display (called by mutator's Exec command)
 	void ShowInputLag();
 
+	// Toggle verified camera-rotation measurement for mouse axes
+	void ToggleVerifiedCameraLag();
+
+	// Toggle late-latched camera rotation on the render thread (registers the view extension)
+	void ToggleLateLatch();
+
+	// Change the sampling policy ("all", "nth <N>", "stride <ms>", "reservoir", "auto [budget_ms]")
+	void SetSamplingMode(const FString& ModeName, const FString& Param);
+
+	// Start a latency sweep over the settings matrix in Game.ini [InputLagSweep.<Profile>] ("stop" ends it early)
+	void StartSweep(const FString& ProfileName);
+
+	// The server scored a hit for a tagged click after holding the tag ServerMs (from AInputLagReporter)
+	void OnHitConfirmed(uint16 FireTag, float ServerMs);
+
+	// Write the hit-confirmation p50/p95 segments to the player and the log, then start collecting afresh
+	void ReportHitConfirm();
+
+	// Write the average and p95 lag breakdowns to the player and the log
+	void ReportAttribution();
+
+	// Write the fire-to-audio p50/p95/p99 next to the visual lag to the player and the log, then start collecting afresh
+	void ReportAudioLatency();
+
+	// Start recording the player controller's input, or stop and write the file
+	void ToggleInputRecording();
+
+	// Replay a recording through the player controller ("stop" abandons the current replay)
+	void StartInputReplay(const FString& FileName);
+
+	// Start the -InputLagReplay=<file> replay on the primary player's session, once per process (sessions outlive map travel)
+	void StartCommandLineReplay();
+
+	// Player controller, before input is processed: next recorded event due now (false when none is)
+	bool PopReplayEvent(FInputLagRecordedEvent& OutEvent);
+
+	// Write the polling summary to the player and the log, then start collecting afresh
+	void ReportPolling();
+
+	// Inject synthetic raw mouse events at Hz for Seconds through Slate, to check the polling analysis
+	void StartMouseInjection(float Hz, float Seconds);
+
+	// Latency-aware frame pacing: "<fps>" or "on" (current t.MaxFPS) starts it, "off" stops it and reports the lag change
+	void SetFramePacing(const FString& Param);
+
 	// Draw the input lag diagnostics overlay (call with Canvas set)
 	void DrawHUD();
 
@@ -66,28 +287,131 @@ public:
 	// Called at end of frame rendering to finalize input lag measurement
 	void FinalizeInputLagMeasurement();
 
-	// Get statistics
+	// Drop the measurement in flight (if any)
+	void ResetPendingMeasurement();
+
+	// Get statistics (game thread; read from the last published snapshot in constant time)
 	float GetAverageInputLag() const;
 	float GetLastInputLag() const;
 	float GetMinInputLag() const;
 	float GetMaxInputLag() const;
 	float Get95thPercentileInputLag() const;
+	float GetSmoothedInputLag() const;
+	float GetRawInputLag() const;
+	const FKey& GetTrackedInputKey() const;
+
+	// Whole snapshot for game-thread readers (UMG, Blueprint, exporters)
+	const FInputLagStatsSnapshot& GetStatsSnapshot() const { return StatsSnapshots.GetPublished(); }
+
+	// Copy of the latest snapshot for any thread and any number of readers (render thread, exporters), lock-free
+	FInputLagStatsSnapshot ReadStatsSnapshot() const { return StatsSnapshots.Read(); }
+
+	// Phase statistics: average lag of inputs arriving in a phase bin, and quantization overhead over all bins
+	float GetPhaseBinAverageLag(int32 Bin) const;
+	float GetAverageQuantizationWait() const;
+	float GetQuantizationShare() const;
+
+	// Write the lag-vs-phase table to the log
+	void LogPhaseSummary() const;
+
+	// Start/stop the Chrome trace export
+	void ToggleTrace();
 
 	// CSV logging
 	void ToggleCSVLogging();
-	void WriteCSVEntry(float InputLag);
+	void WriteCSVEntry(const FInputLagRenderSample& Sample, uint64 LagFrames);
 
 private:
-	// Input event delegates
-	void OnInputKey(FKey Key, EInputEvent EventType);
-	void OnInputAxis(FKey Key, float Delta);
+	// Current final view rotation of the owner's camera manager
+	FRotator GetCameraViewRotation() const;
 
-	// CSV file handle
-	IFileHandle* CSVFileHandle;
-	
-	// CSV file path
-	FString CSVFilePath;
+	// Camera rotation since the pending mouse input arrived, on the axis that input drives
+	float GetObservedAxisDegrees() const;
+
+	// True once the camera rotation has moved on the axis driven by the pending mouse input, in the
+	// direction and by about the amount the calibrated degrees per delta predict
+	bool HasCameraReflectedInput() const;
+
+	// Refine the degrees-per-delta fit with the verified sample about to close
+	void UpdateVerifyCalibration();
+
+	// Feed the late latch this frame's camera rotation and whether the camera follows the mouse
+	void UpdateLateLatch();
+
+	// Add the last latched sample to the comparison once the render thread has applied it (or on bFinal, as unlatched)
+	void ResolveLatchedSample(bool bFinal);
+
+	// Count the frames of every sample whose frame the render thread has finished, feed the pipeline
+	// depth and write the sample's log row
+	void ResolveRenderSamples();
+
+	// Drop the detected depth and the lag attribution; samples still waiting are logged without a frame count
+	void ResetRenderSamples();
+
+	// Recording and replay go through AInputLagPlayerController's input overrides; tells the player
+	// and returns false when the owner is another controller (the mutator does not install it)
+	bool CheckRecordingController(const TCHAR* Feature) const;
+
+	// Advance the sweep and feed it synthetic mouse input
+	void TickSweep(float DeltaTime);
+
+	// Emit the synthetic mouse events due this frame
+	void TickMouseInjection(double Now);
+
+	// Report the lag measured during a replay once its last input has been measured
+	void FinishInputReplay();
+
+	// Recompute the statistics over the history and publish them, if a sample or the sampling mode changed them
+	void PublishStats();
+
+	// Published statistics: written by the game thread once per frame after samples landed, read by getters without locks
+	InputLagCore::TTripleBuffer<FInputLagStatsSnapshot> StatsSnapshots;
+
+	// A sample was added since the last publish
+	bool bStatsDirty;
+
+	// Samples measured by this session
+	uint32 SampleCount;
+
+	// Compressing, rotating CSV writer (Game.ini [InputLagDiagnostics.Logging])
+	FInputLagLogWriter CSVWriter;
 	
 	// Number of samples written to CSV
 	int32 CSVSampleCount;
+
+	// Sampling mode to restore once the sweep is over (sweeps measure every input)
+	EInputLagSamplingMode SweepSavedSamplingMode;
+
+	// Sampling mode to restore once the replay is over (replays measure every input)
+	EInputLagSamplingMode ReplaySavedSamplingMode;
+
+	// A replay was started and has not been reported yet
+	bool bReplayPending;
+
+	// The command line was checked for -InputLagReplay
+	bool bCommandLineReplayChecked;
+
+	// Direction of the next synthetic yaw nudge, alternated so the view does not drift
+	float SyntheticYawDirection;
+
+	// Synthetic mouse injection: rate, time of the next event and end time (0 = not injecting)
+	float InjectionHz;
+	double InjectionNextTime;
+	double InjectionEndTime;
+
+	// Raw mouse events injected in one frame at most, so a long hitch does not flood Slate
+	static const int32 MaxInjectedEventsPerFrame = 256;
+
+	// Frame of the last Tick, so several attached owners do not advance the frame twice
+	uint64 LastTickFrame;
+
+	// Last mouse sample waiting for its latched side: latch sequence (0 = none), arrival time,
+	// unlatched lag and the frame it was measured in
+	uint32 LatchSampleSequence;
+	double LatchSampleInputTime;
+	float LatchSampleUnlatchedMs;
+	uint64 LatchSampleFrame;
+
+	// Frames to wait for the render thread to report a latch before counting a sample as unlatched
+	static const int32 MaxLatchResolveFrames = 3;
 };
\ No newline at end of file
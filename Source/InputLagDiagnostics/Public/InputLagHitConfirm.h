@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Core.h"
+#include "InputLagSketch.h"
+
+/**
+ * Click-to-hit-confirmation latency
+ * Every fire click gets a tag that the owning client sends to the server next to the weapon's
+ * own fire RPC. When the server scores damage for the player it returns the latest tag with the
+ * time it held it, and the client closes the click:
+ * - Local - click to the end of its game-thread frame, when the tag and the fire RPC were sent
+ * - Server - tag received to damage scored, measured on the server
+ * - Network - the rest: both trips, packet scheduling and the client's wait to process the reply
+ * Each segment and the total get their own sketch, so their distributions can be compared.
+ */
+class FInputLagHitConfirm
+{
+public:
+	FInputLagHitConfirm();
+
+	// Clicks remembered while waiting for their confirmation
+	static const int32 MaxPendingClicks = 32;
+
+	// Tag a fire click at Now during Frame; returns 0 if this frame already has a tag
+	uint16 TagClick(double Now, uint64 Frame);
+
+	// Start of a new game-thread frame: clicks from earlier frames have been sent at FrameStart
+	void BeginFrame(double FrameStart, uint64 Frame);
+
+	// The server confirmed a hit for Tag after holding it ServerMs; false if the click is unknown or already confirmed
+	bool Confirm(uint16 Tag, float ServerMs, double Now);
+
+	// Drop all clicks and statistics
+	void Reset();
+
+	// Number of confirmed clicks
+	uint64 GetCount() const { return TotalSketch.GetTotalCount(); }
+
+	// Percentile (0-1) of the total and of each segment
+	float GetTotalPercentile(float Percentile) const { return TotalSketch.GetPercentile(Percentile); }
+	float GetLocalPercentile(float Percentile) const { return LocalSketch.GetPercentile(Percentile); }
+	float GetNetworkPercentile(float Percentile) const { return NetworkSketch.GetPercentile(Percentile); }
+	float GetServerPercentile(float Percentile) const { return ServerSketch.GetPercentile(Percentile); }
+
+	// One-line summary at a percentile ("p50 64.2 ms: local 8.1 / network 49.3 / server 6.8, 23 hits")
+	FString GetSummaryText(float Percentile) const;
+
+private:
+	// One tagged click
+	struct FClick
+	{
+		uint16 Tag;
+		uint64 Frame;
+		double ClickTime;
+		double SentTime;
+	};
+
+	// Ring of tagged clicks
+	FClick Clicks[MaxPendingClicks];
+	int32 NextClick;
+
+	// Tag of the next click (0 is never used)
+	uint16 NextTag;
+
+	// Distributions of the total and its segments
+	FInputLagSketch TotalSketch;
+	FInputLagSketch LocalSketch;
+	FInputLagSketch NetworkSketch;
+	FInputLagSketch ServerSketch;
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Core.h"
+#include "Framework/Application/IInputProcessor.h"
+
+class FInputLagDiagnostics;
+
+/**
+ * Slate input preprocessor that forwards raw mouse movement to the diagnostics as it is pumped
+ * Runs ahead of the viewport and player input stack, so every event is seen individually,
+ * in arrival order, and nothing runs on frames without mouse movement.
+ * Slate has a single preprocessor slot, which this takes over while installed; a processor set
+ * by someone else afterwards replaces it, and is then left alone on removal (see IsInstalled).
+ */
+class FInputLagInputProcessor : public IInputProcessor
+{
+public:
+	FInputLagInputProcessor(FInputLagDiagnostics* InDiagnostics);
+
+	// Detach from the diagnostics object (processor may outlive it until Slate releases it)
+	void ClearDiagnostics() { Diagnostics = nullptr; }
+
+	// True while Slate still ticks this processor, i.e. it still holds the preprocessor slot
+	bool IsInstalled() const { return GFrameCounter - LastTickFrame <= 2; }
+
+	// IInputProcessor interface
+	virtual void Tick(const float DeltaTime, FSlateApplication& SlateApp, TSharedRef<ICursor> Cursor) override;
+	virtual bool HandleMouseMoveEvent(FSlateApplication& SlateApp, const FPointerEvent& MouseEvent) override;
+
+private:
+	// Diagnostics receiving the events (not owned)
+	FInputLagDiagnostics* Diagnostics;
+
+	// Last frame Slate ticked this processor
+	uint64 LastTickFrame;
+};
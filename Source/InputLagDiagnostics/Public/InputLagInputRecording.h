@@ -0,0 +1,124 @@
+#pragma once
+
+#include "Core.h"
+#include "InputCoreTypes.h"
+#include "InputLagSketch.h"
+
+/** One recorded input event, as passed to APlayerController::InputKey or InputAxis */
+struct FInputLagRecordedEvent
+{
+	// Seconds since the start of the recording
+	double Time;
+
+	FKey Key;
+
+	// Key events: event type and AmountDepressed; axis events: Delta and NumSamples
+	bool bAxis;
+	TEnumAsByte<EInputEvent> EventType;
+	float Value;
+	int32 NumSamples;
+
+	bool bGamepad;
+};
+
+/**
+ * Raw input recorder and replayer for comparing builds on identical input
+ * Records every key and axis event the player controller receives, with its arrival time, into
+ * Saved/Logs/InputLagInput_<timestamp>.ilr. A replay feeds the events back through the player
+ * controller's InputKey/InputAxis at the recorded offsets from the replay start, and collects the
+ * lag measured meanwhile, so two builds replaying the same file are measured on the same input.
+ *
+ * The file is little-endian:
+ *   header:   uint32 'ILR1', FString MapName
+ *   key name: uint8 0, uint8 KeyId, FString KeyName (before the first event using the id)
+ *   key:      uint8 1 (| 0x80 for gamepad), uint32 Microseconds, uint8 KeyId, uint8 EventType, float AmountDepressed
+ *   axis:     uint8 2 (| 0x80 for gamepad), uint32 Microseconds, uint8 KeyId, float Delta, uint8 NumSamples
+ */
+class FInputLagInputRecording
+{
+public:
+	FInputLagInputRecording();
+
+	// Longest recording (microsecond offsets stay within 32 bits)
+	static const int32 MaxRecordingSeconds = 3600;
+
+	// Largest recording kept in memory before it is written out and stopped
+	static const int32 MaxRecordingBytes = 64 * 1024 * 1024;
+
+	// Start collecting events in memory
+	void StartRecording(const FString& InMapName);
+
+	// Write the collected events to a new file; returns false if nothing was recorded or the file could not be written
+	bool StopRecording();
+
+	// True while recording (turns false by itself when a size or length limit is reached)
+	bool IsRecording() const { return bRecording; }
+
+	// Record one event arriving at Now
+	void RecordKey(const FKey& Key, EInputEvent EventType, float AmountDepressed, bool bGamepad, double Now);
+	void RecordAxis(const FKey& Key, float Delta, int32 NumSamples, bool bGamepad, double Now);
+
+	// Load a recording for replay (absolute path or a file name in Saved/Logs); returns false if it is missing or malformed
+	bool LoadReplay(const FString& FileName);
+
+	// Start replaying the loaded events with Now as time zero
+	void StartReplay(double Now);
+
+	// Abandon the replay
+	void StopReplay();
+
+	// True from StartReplay until every event was delivered
+	bool IsReplaying() const { return bReplaying; }
+
+	// Next event due at Now (false when none is due yet); the replay ends after the last one
+	bool PopDueEvent(double Now, FInputLagRecordedEvent& OutEvent);
+
+	// Lag measured while replaying
+	void AddReplaySample(float LagMs) { ReplaySketch.Add(LagMs); }
+	const FInputLagSketch& GetReplaySketch() const { return ReplaySketch; }
+
+	// Path of the last written recording or the loaded replay
+	const FString& GetPath() const { return Path; }
+
+	// Map the loaded replay was recorded on
+	const FString& GetReplayMapName() const { return ReplayMapName; }
+
+	// Events recorded so far / in the loaded replay
+	int32 GetEventCount() const { return bRecording ? RecordedEvents : ReplayEvents.Num(); }
+
+	// Replay progress (0-1)
+	float GetReplayProgress() const { return ReplayEvents.Num() > 0 ? (float)NextReplayEvent / ReplayEvents.Num() : 0.0f; }
+
+private:
+	// Id of Key, writing its name record the first time; false once all ids are taken
+	bool GetKeyId(const FKey& Key, uint8& OutId);
+
+	// Offset of Now in microseconds; stops the recording past MaxRecordingSeconds
+	bool GetRecordingOffset(double Now, uint32& OutMicroseconds);
+
+	// Record kinds
+	static const uint8 RecordKeyName = 0;
+	static const uint8 RecordKeyEvent = 1;
+	static const uint8 RecordAxisEvent = 2;
+	static const uint8 RecordGamepadFlag = 0x80;
+
+	// File magic ("ILR1" read as little-endian bytes)
+	static const uint32 FileMagic = 0x31524C49;
+
+	// Recording state
+	bool bRecording;
+	double RecordingStartTime;
+	TArray<uint8> Buffer;
+	TMap<FName, uint8> KeyIds;
+	int32 RecordedEvents;
+
+	// Replay state
+	bool bReplaying;
+	double ReplayStartTime;
+	TArray<FInputLagRecordedEvent> ReplayEvents;
+	int32 NextReplayEvent;
+	FString ReplayMapName;
+	FInputLagSketch ReplaySketch;
+
+	FString Path;
+};
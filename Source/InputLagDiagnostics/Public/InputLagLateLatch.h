@@ -0,0 +1,116 @@
+#pragma once
+
+#include "Core.h"
+#include "Engine.h"
+#include "SceneViewExtension.h"
+
+/**
+ * Late-latched camera rotation for mouse look
+ * Raw mouse counts are summed on the game thread as they are pumped. When a view is set up the
+ * running total is recorded for its frame; just before the render thread renders that view, any
+ * counts pumped since (normally the next game-thread frame's input) are turned into yaw/pitch
+ * and added to the view rotation. The game thread picks the same counts up on its next frame,
+ * so nothing is applied twice; the render thread only shows it up to one frame earlier.
+ *
+ * Counts are converted with degrees-per-count ratios calibrated against the real camera
+ * (least squares over recent frames), so sensitivity, inversion and FOV scaling are whatever the
+ * game applies. Visibility culling still uses the unlatched view, so objects at the screen edge
+ * may pop in a frame late during fast turns.
+ */
+class FInputLagLateLatch : public ISceneViewExtension
+{
+public:
+	FInputLagLateLatch();
+
+	// Turn latching on or off (registration with GEngine->ViewExtensions is up to the owner)
+	void SetEnabled(bool bInEnabled);
+	bool IsEnabled() const { return bEnabled; }
+
+	// Game thread: raw mouse movement as pumped (Y grows upwards)
+	void AddRawDelta(float DeltaX, float DeltaY);
+
+	// Sequence number of the last raw delta added
+	uint32 GetSequence() const;
+
+	// Game thread, once per frame after the camera update: refine the count-to-degree ratios and
+	// allow latching only for ViewActor's view, and only while the camera follows the mouse
+	void UpdateCalibration(const FRotator& CameraRotation, const AActor* ViewActor, bool bInLookActive);
+
+	// True once both ratios have enough movement behind them
+	bool IsCalibrated() const;
+
+	// Calibrated ratios (0 until calibrated)
+	float GetYawDegreesPerCount() const;
+	float GetPitchDegreesPerCount() const;
+
+	// Time the render thread first applied the raw delta with this sequence; false if it never did
+	bool FindLatchTime(uint32 InSequence, double& OutTime) const;
+
+	// ISceneViewExtension interface
+	virtual void SetupViewFamily(FSceneViewFamily& InViewFamily) override {}
+	virtual void SetupView(FSceneViewFamily& InViewFamily, FSceneView& InView) override;
+	virtual void BeginRenderViewFamily(FSceneViewFamily& InViewFamily) override {}
+	virtual void PreRenderViewFamily_RenderThread(FRHICommandListImmediate& RHICmdList, FSceneViewFamily& InViewFamily) override {}
+	virtual void PreRenderView_RenderThread(FRHICommandListImmediate& RHICmdList, FSceneView& InView) override;
+
+private:
+	// Raw count totals recorded when a frame's view was set up
+	struct FLatchBase
+	{
+		uint32 FrameNumber;
+		double CountX;
+		double CountY;
+		uint32 Sequence;
+		bool bApply;
+	};
+
+	// One render-thread latch that applied new input
+	struct FLatchRecord
+	{
+		uint32 FirstSequence;
+		uint32 LastSequence;
+		double Time;
+	};
+
+	// Frames of view setup kept for the render thread to look up (covers the one-frame thread lag)
+	static const int32 NumLatchBases = 4;
+
+	// Latches remembered for matching pending measurements
+	static const int32 NumLatchRecords = 16;
+
+	// Guards everything below; taken by the game thread and the render thread
+	mutable FCriticalSection Lock;
+
+	// Whether views are latched
+	bool bEnabled;
+
+	// Running raw count totals and the number of deltas added
+	double CountX;
+	double CountY;
+	uint32 Sequence;
+
+	// Camera is following the mouse (not paused, no cursor, look input not ignored)
+	bool bLookActive;
+
+	// View target of the player whose mouse is latched (compared on the game thread only)
+	const AActor* LatchedViewActor;
+
+	// Calibration state: previous frame's camera rotation and count totals, and decayed
+	// least-squares sums (degrees x counts, counts squared) per axis
+	FRotator CalibrationRotation;
+	double CalibrationCountX;
+	double CalibrationCountY;
+	bool bHasCalibrationBase;
+	double YawSumXY;
+	double YawSumXX;
+	double PitchSumXY;
+	double PitchSumXX;
+
+	// Ring of view-setup totals by frame number
+	FLatchBase Bases[NumLatchBases];
+	int32 NextBase;
+
+	// Ring of applied latches
+	FLatchRecord Records[NumLatchRecords];
+	int32 NextRecord;
+};
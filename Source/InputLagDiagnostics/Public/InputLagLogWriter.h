@@ -0,0 +1,188 @@
+#pragma once
+
+#include "Core.h"
+
+/**
+ * Output options of an FInputLagLogWriter
+ * The defaults write one plain, unbounded file. LoadFromConfig reads a Game.ini section:
+ *   [InputLagDiagnostics.Logging]
+ *   Compress=true
+ *   BlockSizeKB=64
+ *   BlockFlushSeconds=5
+ *   MaxFileSizeMB=64
+ *   MaxFileMinutes=60
+ *   MaxFiles=20
+ */
+struct FInputLagLogWriterSettings
+{
+	// Write zlib-compressed blocks with an index footer instead of plain text
+	bool bCompress;
+
+	// Uncompressed bytes collected before a block is compressed and written
+	int32 BlockSize;
+
+	// A partial block is written anyway once it is this old, bounding what a crash can lose
+	double BlockFlushSeconds;
+
+	// Start a new file once the current one reaches this size (0 = no limit; checked at block boundaries)
+	int64 MaxFileBytes;
+
+	// Start a new file once the current one is this old (0 = no limit)
+	double MaxFileSeconds;
+
+	// Files matching RetentionPattern to keep next to the output, oldest deleted first (0 = keep all)
+	int32 MaxFiles;
+
+	// Wildcard of the file family MaxFiles applies to, e.g. "InputLagLog_P1_*.csv.ilz"
+	FString RetentionPattern;
+
+	// Text written at the start of every file (e.g. a CSV header row)
+	FString FileHeader;
+
+	FInputLagLogWriterSettings()
+		: bCompress(false)
+		, BlockSize(64 * 1024)
+		, BlockFlushSeconds(5.0)
+		, MaxFileBytes(0)
+		, MaxFileSeconds(0.0)
+		, MaxFiles(0)
+	{
+	}
+
+	// Override the defaults with whatever keys the Game.ini section sets
+	void LoadFromConfig(const TCHAR* Section);
+};
+
+/**
+ * Streams text to a file from a background thread
+ * The game thread only appends to a lock-free queue; the writer thread wakes periodically,
+ * drains the queue and does compression and file IO, so logging never blocks a frame on disk.
+ * One producer thread (the game thread) per writer.
+ *
+ * Compressed files (".ilz" suffix) are a sequence of blocks followed by an index footer,
+ * all little-endian:
+ *   block:   uint32 'ILB1', uint32 UncompressedSize, uint32 CompressedSize, zlib data
+ *            (CompressedSize == UncompressedSize means the block is stored uncompressed)
+ *   index:   per block int64 FileOffset, double FirstTimestamp (Unix seconds), uint32 UncompressedSize, uint32 CompressedSize
+ *   trailer: uint32 NumBlocks, int64 IndexOffset, uint32 'ILIX'
+ * Readers seek by timestamp from the last 16 bytes; a file cut short by a crash has no footer
+ * but its blocks can still be read in order.
+ */
+class FInputLagLogWriter : public FRunnable
+{
+public:
+	FInputLagLogWriter();
+	virtual ~FInputLagLogWriter();
+
+	// Create the first file and start the writer thread; returns false if the file could not be created.
+	// Rotated files insert _001, _002... before the extension of InPath.
+	bool Open(const FString& InPath, const FInputLagLogWriterSettings& InSettings = FInputLagLogWriterSettings());
+
+	// Flush everything queued, finish the current file and stop the thread
+	void Close();
+
+	// Queue text for writing (game thread)
+	void Write(FString&& Text);
+	void Write(const FString& Text);
+
+	// True between a successful Open and Close
+	bool IsOpen() const { return Thread != nullptr; }
+
+	// Path of the first file of the current (or last) log
+	FString GetPath() const { return GetFilePath(0); }
+
+	// Files created since Open (1 + number of rotations)
+	int32 GetFileCount() const { return FilesCreated.GetValue(); }
+
+	// FRunnable interface
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+	// How often the writer thread drains the queue when idle
+	static const uint32 FlushIntervalMs = 50;
+
+private:
+	/** Text waiting for the writer thread, with the time it was queued */
+	struct FQueuedText
+	{
+		FString Text;
+		double Time;
+	};
+
+	/** Footer entry for one compressed block */
+	struct FBlockIndexEntry
+	{
+		int64 Offset;
+		double FirstTimestamp;
+		uint32 UncompressedSize;
+		uint32 CompressedSize;
+	};
+
+	// Write out everything currently queued (writer thread)
+	void Drain();
+
+	// Append text to the current file or block, rotating first if the file is full or old
+	void AppendText(const FString& Text, double Time);
+
+	// Compress and write the collected block
+	void FlushBlock();
+
+	// Create file number FileIndex and write the header; prunes old files of the family
+	bool OpenFile(int32 FileIndex);
+
+	// Write the pending block and index footer, then close the file
+	void FinishFile();
+
+	// Delete the oldest files of the family beyond Settings.MaxFiles
+	void PruneOldFiles();
+
+	// Write raw bytes to the current file
+	void WriteBytes(const uint8* Data, int64 Size);
+
+	// Path of file number FileIndex
+	FString GetFilePath(int32 FileIndex) const;
+
+	// Text waiting for the writer thread
+	TQueue<FQueuedText, EQueueMode::Spsc> PendingText;
+
+	// Wakes the writer thread early when closing
+	FEvent* WakeEvent;
+
+	// Writer thread (nullptr while closed)
+	FRunnableThread* Thread;
+
+	// Open file, only touched by the writer thread once it is running
+	IFileHandle* FileHandle;
+
+	// Set when the writer thread should do a final drain and exit
+	FThreadSafeCounter StopRequested;
+
+	// Output options, fixed between Open and Close
+	FInputLagLogWriterSettings Settings;
+
+	// Path passed to Open
+	FString Path;
+
+	// Writer thread state: current file number, bytes written to it and when it was opened
+	int32 CurrentFileIndex;
+	int64 FileBytes;
+	double FileOpenTime;
+
+	// Uncompressed bytes of the block being collected, its first timestamp and when collection started
+	TArray<uint8> BlockBuffer;
+	double BlockFirstTime;
+	double BlockStartTime;
+
+	// Scratch space for compression
+	TArray<uint8> CompressedBuffer;
+
+	// Blocks written to the current file
+	TArray<FBlockIndexEntry> BlockIndex;
+
+	// Maps FPlatformTime::Seconds() to Unix time for the index footer
+	double UnixTimeAtOpen;
+	double SecondsAtOpen;
+
+	// Files created since Open
+	FThreadSafeCounter FilesCreated;
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Core.h"
+#include "InputLagHUD.h"
+#include "InputLagPlayerTable.h"
+#include "InputLagFramePacer.h"
+#include "InputLagLateLatch.h"
+
+/** Handle to a measurement session owned by FInputLagMeasurementService */
+struct FInputLagSessionHandle
+{
+	// Session slot (INDEX_NONE = not attached)
+	int32 Slot;
+
+	FInputLagSessionHandle()
+		: Slot(INDEX_NONE)
+	{
+	}
+
+	explicit FInputLagSessionHandle(int32 InSlot)
+		: Slot(InSlot)
+	{
+	}
+
+	bool IsValid() const { return Slot != INDEX_NONE; }
+};
+
+/**
+ * Module-owned measurement service
+ * Holds one measurement session per local player slot for the lifetime of the module, so
+ * history, statistics and logs survive map travel and reconnects. The mutator, player
+ * controller and HUD attach to a session by handle instead of owning one.
+ * Per-player hot state is kept in one shared FInputLagPlayerTable; the service drives its
+ * frame boundaries once per frame for all players, and runs the optional frame pacer there.
+ */
+class FInputLagMeasurementService
+{
+public:
+	// Number of local player slots; all session storage is allocated once at module startup
+	static const int32 MaxSessions = FInputLagPlayerTable::MaxPlayers;
+
+	FInputLagMeasurementService();
+	~FInputLagMeasurementService();
+
+	// Attach to the session for a local player slot (slot 0 is the primary local player)
+	FInputLagSessionHandle Attach(int32 Slot = 0);
+
+	// Release a handle; if the session is still bound to Owner, or this was its last handle, it is
+	// unbound and its pending measurement dropped, but its history and logs are kept
+	void Detach(FInputLagSessionHandle& Handle, APlayerController* Owner);
+
+	// Session behind a handle (nullptr for invalid handles)
+	FInputLagDiagnostics* Resolve(const FInputLagSessionHandle& Handle);
+
+	// Process-wide latency-aware frame pacer (off unless enabled)
+	FInputLagFramePacer& GetFramePacer() { return FramePacer; }
+
+	// Local player index of a controller, clamped to the session range (INDEX_NONE for non-local controllers)
+	static int32 GetLocalPlayerSlot(APlayerController* PC);
+
+private:
+	// Frame boundary callbacks (FCoreDelegates::OnBeginFrame / OnEndFrame)
+	void OnBeginFrame();
+	void OnEndFrame();
+
+	// Render-thread view extension latching the primary player's mouse look (shared with session 0)
+	TSharedPtr<FInputLagLateLatch, ESPMode::ThreadSafe> LateLatch;
+
+	// Sleeps at the start of the frame while pacing is enabled
+	FInputLagFramePacer FramePacer;
+
+	// Shared per-player state; declared before the sessions that point into it
+	FInputLagPlayerTable Players;
+
+	// Sessions live in place for the lifetime of the service and never move
+	FInputLagDiagnostics Sessions[MaxSessions];
+
+	// Number of handles currently attached to each session (the slot is released at 0)
+	int32 AttachCounts[MaxSessions];
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "Core.h"
+#include "RenderingThread.h"
+
+/**
+ * Frame-count lag histogram and pipeline depth detection
+ * Each sample counts the game frames from its input's frame to the game frame that was running
+ * when the render thread got through the frame that measured it (see FInputLagRenderStamps).
+ * The session histogram shows how that is spread; the
+ * effective pipeline depth is the frame count most of the last WindowSize samples share. A new
+ * depth that holds half the window is reported as a change (e.g. the render thread falling one
+ * more frame behind), which is the usual cause of a sudden lag step at an unchanged frame rate.
+ * Queueing after the render thread (RHI thread, GPU, driver present queue) is not counted.
+ */
+class FInputLagPipelineDepth
+{
+public:
+	FInputLagPipelineDepth();
+
+	// Frame counts kept apart; higher counts share the last bucket
+	static const int32 MaxFrames = 8;
+
+	// Recent samples the depth is detected over
+	static const int32 WindowSize = 64;
+
+	// Add a sample whose frame the render thread finished Frames frames after its input's; true when the detected depth changed
+	bool AddSample(uint64 Frames, double Now);
+
+	// Drop the histogram and the detected depth
+	void Reset();
+
+	// Detected depth in frames (0 until WindowSize samples were seen) and the one before the last change (0 if none)
+	int32 GetDepth() const { return Depth; }
+	int32 GetPreviousDepth() const { return PreviousDepth; }
+
+	// Time of the last depth change (0 if none)
+	double GetChangeTime() const { return ChangeTime; }
+
+	// Samples in the session histogram
+	uint64 GetTotalCount() const { return TotalCount; }
+
+	// Session histogram as shares of the samples ("1:12% 2:80% 3:8%", buckets under 1% left out)
+	FString GetHistogramText() const;
+
+private:
+	// Session histogram, indexed by frame count (0 unused)
+	uint64 Counts[MaxFrames + 1];
+	uint64 TotalCount;
+
+	// Ring of the last WindowSize frame counts and their histogram
+	uint8 Window[WindowSize];
+	int32 WindowIndex;
+	int32 WindowFill;
+	int32 WindowCounts[MaxFrames + 1];
+
+	int32 Depth;
+	int32 PreviousDepth;
+	double ChangeTime;
+};
+
+/** Render-thread side of FInputLagRenderStamps: time and sequence of the last stamp written to each slot */
+struct FInputLagRenderStampSlots
+{
+	static const int32 NumSlots = 16;
+
+	double Time[NumSlots];
+	volatile int32 Sequence[NumSlots];
+
+	FInputLagRenderStampSlots()
+	{
+		FMemory::Memzero(Time, sizeof(Time));
+		FMemory::Memzero((void*)Sequence, sizeof(Sequence));
+	}
+};
+
+/**
+ * Render-thread completion stamps for measured frames
+ * Stamp queues a render command behind everything the game thread has enqueued so far; when the
+ * render thread reaches it, it writes the time into a slot the game thread polls. Stamps complete
+ * in order, and up to NumSlots can be in flight. Recent game frame start times are kept too, so a
+ * completion time can be placed in the game frame that was running when the render thread got there.
+ */
+class FInputLagRenderStamps
+{
+public:
+	FInputLagRenderStamps();
+
+	// Stamps that can be in flight at once
+	static const int32 Capacity = FInputLagRenderStampSlots::NumSlots;
+
+	// Queue a stamp (game thread); returns its sequence, never 0
+	uint32 Stamp();
+
+	// Time the render thread reached the stamp; false while it has not yet
+	bool GetTime(uint32 Sequence, double& OutTime) const;
+
+	// Note the start of a game frame (once per frame)
+	void AddFrameStart(uint64 Frame, double StartTime);
+
+	// Latest noted frame that had started by Time, and its start; false if Time is before every noted frame
+	bool FindFrame(double Time, uint64& OutFrame, double& OutStartTime) const;
+
+private:
+	// Shared with the render commands, which may still run after the owner is gone
+	TSharedRef<FInputLagRenderStampSlots, ESPMode::ThreadSafe> Slots;
+
+	uint32 NextSequence;
+
+	// Ring of recent game frames and their start times, indexed by frame number
+	uint64 Frames[Capacity];
+	double FrameStarts[Capacity];
+};
@@ -3,11 +3,14 @@
 #include "Core.h"
 #include "Engine.h"
 #include "GameFramework/PlayerController.h"
+#include "InputLagMeasurementService.h"
 #include "InputLagPlayerController.generated.h"
 
 /**
  * Custom PlayerController that adds input lag diagnostics
  * Tracks the time from input arrival to execution
+ * Measurement state lives in the module's measurement service; the controller attaches to its
+ * local player's session by handle and feeds it input
  */
 UCLASS()
 class AInputLagPlayerController : public APlayerController
@@ -15,45 +18,44 @@ class AInputLagPlayerController : public APlayerController
 	GENERATED_UCLASS_BODY()
 
 public:
-	// Toggle for showing input lag diagnostics
+	// Handle to this local player's measurement session (invalid on servers and remote controllers)
+	FInputLagSessionHandle SessionHandle;
+
+	// Deprecated: mirror of the session's enable flag, kept for Blueprints written against the old
+	// controller; setting it toggles diagnostics on the next PlayerTick
 	UPROPERTY(BlueprintReadWrite, Category = "Input Lag")
 	bool bShowInputLagDiagnostics;
 
-	// Last recorded input timestamp
-	double LastInputTimestamp;
-
-	// Frame number when the input was recorded
-	uint64 InputFrameNumber;
-
-	// Last tracked input key name
-	FKey LastTrackedInputKey;
-
-	// Whether we're waiting to measure input lag
-	bool bPendingInputMeasurement;
-
-	// History of input lag measurements (in milliseconds) - circular buffer
-	TArray<float> InputLagHistory;
+	// Console command to toggle input lag display
+	UFUNCTION(Exec)
+	void ShowInputLag();
 
-	// Current index in the circular buffer
-	int32 HistoryIndex;
+	// Console command to toggle verified camera-rotation measurement for mouse axes
+	UFUNCTION(Exec)
+	void VerifyInputLag();
 
-	// Smoothed input lag value (exponential moving average)
-	float SmoothedInputLag;
+	// Console command to change the sampling policy: all | nth <N> | stride <ms> | reservoir | auto [budget_ms]
+	UFUNCTION(Exec)
+	void InputLagSampling(const FString& ModeName, const FString& Param);
 
-	// Raw (unsmoothed) input lag from last measurement
-	float RawInputLag;
+	// Console command to start/stop the Chrome trace export
+	UFUNCTION(Exec)
+	void InputLagTrace();
 
-	// Maximum number of samples to keep
-	static const int32 MaxInputLagSamples = 200;
+	// Console command to start recording this controller's input, or stop and save it
+	UFUNCTION(Exec)
+	void InputLagRecord();
 
-	// Console command to toggle input lag display
+	// Console command to replay a recording (file name in Saved/Logs or a full path; "stop" abandons it)
 	UFUNCTION(Exec)
-	void ShowInputLag();
+	void InputLagReplay(const FString& FileName);
 
-	// Record the timestamp when an input is received
-	void RecordInputTimestamp(FKey Key);
+	// Record the timestamp when an input is received; AxisDelta is the mouse movement for axis keys
+	// (0 reads the key's current axis value)
+	void RecordInputTimestamp(FKey Key, float AxisDelta = 0.0f);
 
-	// Record when the input action executes and calculate lag
+	// Deprecated: measurements now close on the first frame drawn after the input; closes the
+	// pending measurement if Key is the tracked key
 	void RecordInputExecution(FKey Key);
 
 	// Get the average input lag from history
@@ -84,6 +86,13 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Input Lag")
 	float GetRawInputLag() const;
 
+	// Attach to / detach from the measurement service
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Opens a new measurement budget frame for the sampler
+	virtual void PlayerTick(float DeltaTime) override;
+
 	// Override input functions to track timestamps
 	virtual bool InputKey(FKey Key, EInputEvent EventType, float AmountDepressed, bool bGamepad) override;
 	virtual bool InputAxis(FKey Key, float Delta, float DeltaTime, int32 NumSamples, bool bGamepad) override;
@@ -91,4 +100,23 @@ public:
 	// Called at the end of the frame to finalize input lag measurement
 	// Public so HUD can call it at end of rendering
 	void MeasureInputLagEndOfFrame();
+
+protected:
+	// Session behind SessionHandle (nullptr when not attached)
+	FInputLagDiagnostics* GetSession() const;
+
+	// Feed the recorded events due this frame through InputKey/InputAxis
+	void ReplayInput(float DeltaTime);
+
+	// Session resolved once in BeginPlay
+	FInputLagDiagnostics* CachedSession;
+
+	// Set while ReplayInput delivers recorded events (live input is held back during a replay)
+	bool bInjectingReplay;
+
+	// Session enable flag last copied into bShowInputLagDiagnostics (a difference is a Blueprint write)
+	bool bMirroredShowInputLag;
+
+	// RecordInputExecution has logged its deprecation warning
+	bool bWarnedRecordInputExecution;
 };
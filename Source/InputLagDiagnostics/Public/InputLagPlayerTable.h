@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Core.h"
+#include "InputCoreTypes.h"
+
+/**
+ * Per-local-player measurement state in struct-of-arrays layout
+ * Every column has one entry per local player slot (history columns have HistoryCapacity
+ * entries per slot). Frame-wide passes such as closing the input frame walk a single
+ * column for all players instead of touching every session object.
+ */
+struct FInputLagPlayerTable
+{
+	// Local player slots (split-screen players or simulated local players)
+	static const int32 MaxPlayers = 4;
+
+	// Samples kept in each player's history ring
+	static const int32 HistoryCapacity = 200;
+
+	FInputLagPlayerTable();
+
+	// Pending measurement: arrival time, arrival frame, tracked key and whether one is in flight
+	TArray<double> InputTimestamp;
+	TArray<uint64> InputFrame;
+	TArray<FKey> TrackedKey;
+	TArray<bool> PendingMeasurement;
+
+	// Mouse axis delta accumulated while a verified measurement is pending
+	TArray<float> PendingAxisDelta;
+
+	// Late-latch sequence of the pending mouse input (0 = late latching off)
+	TArray<uint32> LatchSequence;
+
+	// Start and end of the frame the pending input arrived in (end is 0 until that frame finishes)
+	TArray<double> InputFrameStart;
+	TArray<double> InputFrameEnd;
+
+	// Smoothed (EMA) and raw lag of the last measurement, in milliseconds
+	TArray<float> SmoothedLag;
+	TArray<float> RawLag;
+
+	// Next write position in each player's history ring
+	TArray<int32> HistoryIndex;
+
+	// History rings and their sampling weights, HistoryCapacity entries per player
+	TArray<float> History;
+	TArray<float> Weights;
+
+	// Start time of the frame currently being processed (shared by all players)
+	double CurrentFrameStart;
+
+	// First entry of a player's history / weight ring
+	float* GetHistory(int32 Slot) { return History.GetData() + Slot * HistoryCapacity; }
+	const float* GetHistory(int32 Slot) const { return History.GetData() + Slot * HistoryCapacity; }
+	float* GetWeights(int32 Slot) { return Weights.GetData() + Slot * HistoryCapacity; }
+	const float* GetWeights(int32 Slot) const { return Weights.GetData() + Slot * HistoryCapacity; }
+
+	// Clear a player's pending measurement columns
+	void ResetPending(int32 Slot);
+
+	// Frame boundaries: stamp the shared frame start, close the input frame of every pending player
+	void BeginFrame(double Now);
+	void EndFrame(double Now);
+};
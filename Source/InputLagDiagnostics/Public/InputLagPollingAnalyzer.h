@@ -0,0 +1,128 @@
+#pragma once
+
+#include "Core.h"
+
+/** Summary of recent mouse event delivery, refreshed a few times per second */
+struct FInputLagPollingStats
+{
+	// Events per second while the mouse is moving (idle gaps excluded)
+	float EffectiveRateHz;
+
+	// Time between consecutive delivered events while moving: median, 99th percentile and standard deviation
+	float IntervalP50Ms;
+	float IntervalP99Ms;
+	float JitterMs;
+
+	// Events delivered per frame, over frames that had any
+	float EventsPerFrame;
+	int32 MaxEventsPerFrame;
+
+	// Events coalesced into one InputAxis call (its NumSamples argument)
+	float SamplesPerAxisCall;
+	int32 MaxSamplesPerAxisCall;
+
+	// Intervals the summary is based on
+	int32 NumIntervals;
+
+	// InputAxis calls behind the per-call figures (0 without AInputLagPlayerController, which reports them)
+	int32 NumAxisCalls;
+
+	FInputLagPollingStats()
+		: EffectiveRateHz(0.0f)
+		, IntervalP50Ms(0.0f)
+		, IntervalP99Ms(0.0f)
+		, JitterMs(0.0f)
+		, EventsPerFrame(0.0f)
+		, MaxEventsPerFrame(0)
+		, SamplesPerAxisCall(0.0f)
+		, MaxSamplesPerAxisCall(0)
+		, NumIntervals(0)
+		, NumAxisCalls(0)
+	{
+	}
+
+	// One-line description for the HUD and log
+	FString Describe() const;
+};
+
+/**
+ * Mouse polling-rate and delivery jitter analyzer
+ * Records the arrival time of every raw mouse event (from the Slate preprocessor), how many
+ * events each frame delivered, and how many events the engine coalesced into each InputAxis
+ * call. Arrival times are when the game thread pumped the event, not device timestamps, so a
+ * 1000 Hz mouse at 120 fps shows bursts of about 8 events with near-zero spacing and one gap per
+ * frame; the effective rate (events per second while moving) still matches the polling rate.
+ */
+class FInputLagPollingAnalyzer
+{
+public:
+	FInputLagPollingAnalyzer();
+
+	// Intervals kept for the distribution
+	static const int32 MaxIntervals = 2048;
+
+	// Frames and InputAxis calls kept for the batching statistics
+	static const int32 MaxFrames = 256;
+
+	// Gaps longer than this, or than two frames at low frame rates, are the mouse resting, not polling
+	static const int32 MinIdleGapMs = 50;
+
+	// Count one raw device event arriving now
+	void AddRawEvent(double Now);
+
+	// Count one InputAxis call and the events coalesced into it
+	void AddAxisCall(int32 NumSamples);
+
+	// Close the previous frame's event count; refreshes the summary every RefreshSeconds
+	void BeginFrame(double Now);
+
+	// Drop everything recorded so far
+	void Reset();
+
+	// Recompute the summary now instead of waiting for the next refresh
+	void RefreshStats();
+
+	// Latest summary
+	const FInputLagPollingStats& GetStats() const { return Stats; }
+
+	// True once enough movement was seen for the summary to mean anything
+	bool HasStats() const { return Stats.NumIntervals >= MinIntervals; }
+
+private:
+	// Intervals needed before stats are shown
+	static const int32 MinIntervals = 32;
+
+	// Seconds between summary refreshes
+	static const double RefreshSeconds;
+
+	// Inter-arrival times in milliseconds (ring)
+	TArray<float> Intervals;
+	int32 IntervalIndex;
+	int32 IntervalCount;
+
+	// Events per frame, frames with at least one event only (ring)
+	TArray<float> FrameEvents;
+	int32 FrameIndex;
+	int32 FrameCount;
+
+	// NumSamples per InputAxis call (ring)
+	TArray<float> AxisSamples;
+	int32 AxisIndex;
+	int32 AxisCount;
+
+	// Arrival time of the previous event (0 = none yet)
+	double LastEventTime;
+
+	// Start of the current frame (0 = none yet) and the gap that currently counts as idle
+	double FrameStartTime;
+	float IdleGapMs;
+
+	// Events delivered so far this frame
+	int32 EventsThisFrame;
+
+	// Time of the last summary refresh
+	double LastRefreshTime;
+
+	// Latest summary
+	FInputLagPollingStats Stats;
+};
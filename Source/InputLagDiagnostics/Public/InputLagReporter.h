@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Core.h"
+#include "Engine.h"
+#include "InputLagMeasurementService.h"
+#include "InputLagReporter.generated.h"
+
+class AInputLagDiagnosticsMutator;
+
+/**
+ * Per-player latency reporter
+ * Spawned by the mutator on the server for every player controller and replicated only to its
+ * owner. On the owning client it periodically sends the lag sketch collected since the last
+ * report over a reliable server RPC; on the server the counts are merged by the mutator into
+ * per-player and match-wide sketches.
+ *
+ * It also carries hit-confirmation timing: the owning client sends each tagged fire click to
+ * the server, and when the server scores damage for the player it returns the tag with the time
+ * it held it, so the client can split click-to-confirm into local, network and server segments.
+ */
+UCLASS(NotPlaceable, Transient)
+class AInputLagReporter : public AActor
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+	// Seconds between reports; bounds the RPC rate regardless of frame rate or sample count
+	UPROPERTY(EditDefaultsOnly, Category = "Input Lag")
+	float ReportInterval;
+
+	// Server only: mutator that aggregates this player's reports
+	UPROPERTY()
+	AInputLagDiagnosticsMutator* Mutator;
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void OnRep_Owner() override;
+
+	// Delta sketch counts since the previous report (at most FInputLagSketch::NumBuckets entries)
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerReportSketch(const TArray<uint16>& Counts);
+
+	// Tag of a fire click, sent in the same frame as the weapon's fire RPC
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerFireTag(uint16 FireTag);
+
+	// The server scored a hit after holding the latest fire tag for ServerMs
+	UFUNCTION(Client, Reliable)
+	void ClientConfirmHit(uint16 FireTag, float ServerMs);
+
+	// Server: the player scored damage; confirms the outstanding fire tag (if any)
+	void ConfirmHit();
+
+protected:
+	// Timer callback on the owning client: send whatever the local session collected
+	void SendReport();
+
+	// Owning client: attach to the local player's session and subscribe to its fire tags (null if not local yet)
+	FInputLagDiagnostics* GetLocalSession();
+
+	// Owning client: forward a tagged fire click to the server
+	void OnFireTagged(uint16 FireTag);
+
+	// Handle to the owning local player's session (owning client only)
+	FInputLagSessionHandle SessionHandle;
+
+	// Subscription to the session's OnFireTagged
+	FDelegateHandle FireTaggedHandle;
+
+	// Report timer
+	FTimerHandle ReportTimerHandle;
+
+	// Server: latest unconfirmed fire tag (0 = none) and when it arrived (FPlatformTime::Seconds)
+	uint16 PendingFireTag;
+	double PendingFireTime;
+};
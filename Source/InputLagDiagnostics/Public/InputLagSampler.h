@@ -0,0 +1,157 @@
+#pragma once
+
+#include "Core.h"
+
+/** How eligible inputs are selected for measurement */
+enum class EInputLagSamplingMode : uint8
+{
+	// Measure every eligible input
+	All,
+	// Measure one in every N eligible inputs
+	EveryNth,
+	// Measure at most one input per stride interval
+	TimeStride,
+	// Keep a uniform session-wide reservoir; acceptance probability falls as the session grows
+	Reservoir,
+	// Measure everything until the per-frame CPU budget is exceeded, then degrade to every-Nth
+	Auto
+};
+
+/**
+ * Sampling policy that sits in front of input timestamp recording
+ * Decides which inputs start a measurement, enforces a hard per-frame CPU budget and
+ * hands out Horvitz-Thompson weights so percentiles stay unbiased while sampling
+ */
+class FInputLagSampler
+{
+public:
+	FInputLagSampler();
+
+	// Active sampling mode
+	EInputLagSamplingMode Mode;
+
+	// N for EveryNth mode
+	int32 SampleEveryN;
+
+	// Minimum time between samples in TimeStride mode
+	double StrideSeconds;
+
+	// Hard CPU budget for measurement work per frame
+	double FrameBudgetSeconds;
+
+	// Number of slots in the session-wide reservoir
+	static const int32 ReservoirCapacity = 1024;
+
+	// Upper bound for the stride Auto mode may degrade to
+	static const int32 MaxAutoStride = 64;
+
+	// Consecutive quiet frames before Auto mode halves its stride again
+	static const int32 AutoRecoverFrames = 120;
+
+	// Offer an eligible input; returns true if it should start a measurement
+	bool ShouldSample(double Now);
+
+	// Count an eligible input that arrived while a measurement was in flight (it cannot be measured,
+	// but the next sample's weight includes it; the reservoir only counts inputs it could measure)
+	void CountBusyOffer();
+
+	// Weight of the sample accepted by the last successful ShouldSample (inputs it stands for)
+	float GetSampleWeight() const { return PendingSampleWeight; }
+
+	// Store a completed measurement (fills the reservoir slot reserved by ShouldSample)
+	void AddMeasurement(float LagMs);
+
+	// The measurement in flight will not complete; releases its reservoir slot
+	void DropMeasurement();
+
+	// Called once per frame before any input is offered; adapts Auto mode to the last frame's cost
+	void BeginFrame();
+
+	// Charge measurement work to the current frame's budget
+	void AddWorkCycles(uint32 Cycles) { FrameWorkCycles += Cycles; }
+
+	// True when the sampler is currently measuring less than every eligible input
+	bool IsSampling() const;
+
+	// Effective stride (1 = every input) for display
+	int32 GetEffectiveStride() const;
+
+	// Measurement CPU time spent in the previous frame
+	double GetLastFrameWorkSeconds() const { return LastFrameWorkSeconds; }
+
+	// Percentile from the reservoir (Reservoir mode only)
+	float GetReservoirPercentile(float Percentile) const;
+
+	// Weighted mean over the reservoir (Reservoir mode only)
+	float GetReservoirAverage() const;
+
+	// Human readable mode name
+	FString GetModeName() const;
+
+	// Parse "all", "nth <N>", "stride <ms>", "reservoir", "auto [budget_ms]"; returns false on bad input
+	bool SetModeFromString(const FString& ModeName, const FString& Param);
+
+	// Weighted percentile over parallel value/weight arrays (zero values are treated as empty slots, null weights count 1 each)
+	static float GetWeightedPercentile(const float* Values, const float* Weights, int32 Num, float Percentile);
+
+	// Weighted mean over parallel value/weight arrays (zero values are treated as empty slots, null weights count 1 each)
+	static float GetWeightedAverage(const float* Values, const float* Weights, int32 Num);
+
+private:
+	// Eligible inputs offered since the last accepted one (including budget rejections)
+	int32 OffersSinceSample;
+
+	// Inputs offered over the whole session that passed the busy and budget checks (reservoir algorithm R counter)
+	int64 TotalOffers;
+
+	// Current every-Nth stride chosen by Auto mode
+	int32 AutoStride;
+
+	// Frames in a row Auto mode stayed under half budget
+	int32 QuietFrames;
+
+	// Time of the last accepted sample (TimeStride mode)
+	double LastSampleTime;
+
+	// Weight handed to the measurement currently in flight
+	float PendingSampleWeight;
+
+	// Reservoir slot reserved for the measurement in flight (INDEX_NONE if none)
+	int32 PendingReservoirSlot;
+
+	// Measurement work done so far this frame
+	uint32 FrameWorkCycles;
+
+	// Measurement work done in the previous frame
+	double LastFrameWorkSeconds;
+
+	// Uniform sample of the whole session
+	TArray<float> Reservoir;
+
+	// Number of reservoir slots filled so far
+	int32 ReservoirCount;
+
+	// xorshift64* state for reservoir draws (FRand has only 24 bits, too few for long sessions)
+	uint64 RandomState;
+
+	// Uniform draw in [0, Range)
+	int64 RandomOffer(int64 Range);
+};
+
+/** Charges the enclosing scope's CPU time to a sampler's per-frame budget */
+struct FInputLagScopedWork
+{
+	FInputLagScopedWork(FInputLagSampler& InSampler)
+		: Sampler(InSampler)
+		, StartCycles(FPlatformTime::Cycles())
+	{
+	}
+
+	~FInputLagScopedWork()
+	{
+		Sampler.AddWorkCycles(FPlatformTime::Cycles() - StartCycles);
+	}
+
+	FInputLagSampler& Sampler;
+	uint32 StartCycles;
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Core.h"
+#include "InputLagCore/InputLagCoreHistogram.h"
+
+/**
+ * Mergeable log-bucketed latency histogram
+ * Fixed bucket layout, so sketches from any number of clients merge by adding counts and the
+ * wire size is bounded no matter how many samples were collected. Bucket 0 holds lags below
+ * 0.5 ms, the last bucket holds lags of 1 s or more, and the buckets in between grow
+ * geometrically (about 13% wide, so percentiles are within roughly 6% of the true value).
+ */
+class FInputLagSketch
+{
+public:
+	// Bucket count, fixed for every client and server
+	static const int32 NumBuckets = 64;
+
+	// Count a lag sample Weight times (Weight = number of inputs the sample stands for)
+	void Add(float LagMs, uint32 Weight = 1) { Histogram.Add(LagMs, Weight); }
+
+	// Add another sketch's counts
+	void Merge(const FInputLagSketch& Other) { Histogram.Merge(Other.Histogram); }
+
+	// Add counts received over the network (at most NumBuckets entries)
+	void MergeCounts(const TArray<uint16>& InCounts);
+
+	// Move up to 65535 counts per bucket into OutCounts (trailing empty buckets trimmed) and keep the rest
+	void ExtractCounts(TArray<uint16>& OutCounts);
+
+	// Drop all counts
+	void Reset() { Histogram.Reset(); }
+
+	// Total samples counted
+	uint64 GetTotalCount() const { return Histogram.GetTotalCount(); }
+
+	// Approximate lag at a percentile (0-1); 0 when empty
+	float GetPercentile(float Percentile) const { return Histogram.GetPercentile(Percentile); }
+
+private:
+	// Engine-free bucket layout and arithmetic
+	InputLagCore::TLogHistogram<NumBuckets> Histogram;
+};
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "Core.h"
+
+/** One combination of frame-pacing settings in a sweep matrix */
+struct FInputLagSweepConfig
+{
+	// t.MaxFPS (0 = uncapped)
+	float MaxFPS;
+
+	// r.OneFrameThreadLag
+	int32 OneFrameThreadLag;
+
+	// r.VSync
+	int32 VSync;
+
+	// r.FinishCurrentFrame
+	int32 FinishCurrentFrame;
+
+	// UEngine::bSmoothFrameRate
+	bool bSmoothFrameRate;
+
+	FInputLagSweepConfig()
+		: MaxFPS(0.0f)
+		, OneFrameThreadLag(1)
+		, VSync(0)
+		, FinishCurrentFrame(0)
+		, bSmoothFrameRate(false)
+	{
+	}
+
+	// Short description for HUD and logs
+	FString Describe() const;
+};
+
+/** Samples collected while one sweep configuration was active */
+struct FInputLagSweepResult
+{
+	FInputLagSweepConfig Config;
+
+	// Lag samples in milliseconds
+	TArray<float> Samples;
+
+	// Frame time accumulated after warmup (for average frame time)
+	double FrameTimeSum;
+	int32 FrameCount;
+
+	FInputLagSweepResult()
+		: FrameTimeSum(0.0)
+		, FrameCount(0)
+	{
+	}
+};
+
+/**
+ * Latency sweep benchmark
+ * Walks a matrix of frame-pacing settings read from a Game.ini profile, holds each one until
+ * enough samples are collected, restores the original settings and writes one CSV report
+ *
+ * Profile format (any key may be omitted to keep the current value):
+ *   [InputLagSweep.<Profile>]
+ *   MaxFPS=0,60,120,240
+ *   OneFrameThreadLag=1,0
+ *   VSync=0
+ *   FinishCurrentFrame=0,1
+ *   SmoothFrameRate=0
+ *   SamplesPerConfig=200
+ *   WarmupFrames=60
+ *   ConfigTimeoutSeconds=30
+ *   SyntheticInput=true
+ */
+class FInputLagSweep
+{
+public:
+	FInputLagSweep();
+
+	// Samples to collect for each configuration
+	int32 SamplesPerConfig;
+
+	// Frames to discard after switching configuration
+	int32 WarmupFrames;
+
+	// Give up on a configuration after this long, even if it has too few samples
+	float ConfigTimeoutSeconds;
+
+	// Generate mouse input while sweeping instead of waiting for the player
+	bool bSyntheticInput;
+
+	// Load a profile and apply its first configuration; returns false if the profile yields no configurations
+	bool Start(const FString& InProfileName);
+
+	// Restore the original settings and write the report for whatever was collected
+	void Stop();
+
+	// Advance warmup and move to the next configuration once the current one is done
+	void Tick(float DeltaTime);
+
+	// Feed one completed measurement
+	void AddSample(float LagMs);
+
+	// True while the sweep is running
+	bool IsRunning() const { return bRunning; }
+
+	// Configuration currently applied (changes when the sweep moves on)
+	int32 GetConfigIndex() const { return CurrentConfig; }
+
+	// True when the caller should inject synthetic input this frame
+	bool WantsSyntheticInput() const { return bRunning && bSyntheticInput; }
+
+	// One-line progress text for the HUD
+	FString GetStatusText() const;
+
+	// Path of the last report written
+	const FString& GetReportPath() const { return ReportPath; }
+
+private:
+	// Build the settings matrix from Game.ini (falls back to a built-in default matrix)
+	void LoadProfile();
+
+	// Push a configuration into the console variables and engine
+	void ApplyConfig(const FInputLagSweepConfig& Config);
+
+	// Remember / restore the settings that were active before the sweep
+	void CaptureOriginalSettings();
+	void RestoreOriginalSettings();
+
+	// Write the per-configuration lag distributions
+	bool WriteReport();
+
+	// Console variable helpers
+	static FString GetConsoleVariable(const TCHAR* Name);
+	static void SetConsoleVariable(const TCHAR* Name, const FString& Value);
+
+	// Parse a comma separated list of numbers from the profile section
+	static TArray<float> ReadList(const FString& Section, const TCHAR* Key, float CurrentValue);
+
+	// Name of the profile being swept
+	FString ProfileName;
+
+	// One entry per configuration in the matrix
+	TArray<FInputLagSweepResult> Results;
+
+	// Index of the configuration currently applied
+	int32 CurrentConfig;
+
+	// Frames left before samples count for the current configuration
+	int32 WarmupFramesLeft;
+
+	// Time spent in the current configuration
+	float ConfigElapsed;
+
+	// Whether a sweep is in progress
+	bool bRunning;
+
+	// Console variable values before the sweep
+	TMap<FString, FString> OriginalSettings;
+
+	// UEngine::bSmoothFrameRate before the sweep
+	bool bOriginalSmoothFrameRate;
+
+	// Report file written by the last sweep
+	FString ReportPath;
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Core.h"
+#include "InputCoreTypes.h"
+#include "InputLagLogWriter.h"
+
+/** Timeline tracks of an input lag trace (Chrome trace thread ids) */
+enum class EInputLagTraceTrack : int32
+{
+	Frames = 1,
+	Input = 2,
+	GameThread = 3,
+	HUD = 4
+};
+
+/**
+ * Chrome trace JSON export of tracked inputs
+ * Writes frame boundary slices and one flow per measured input (arrival -> game-thread
+ * consumption -> HUD draws -> completion or drop) so a captured session can be opened in
+ * chrome://tracing or ui.perfetto.dev. Events are formatted on the game thread and written
+ * by an FInputLagLogWriter thread.
+ */
+class FInputLagTrace
+{
+public:
+	FInputLagTrace();
+
+	// Open Saved/Logs/InputLagTrace_<timestamp>.json and write the track names
+	bool Start(int32 PlayerSlot);
+
+	// Terminate the JSON and close the file
+	void Stop();
+
+	// True while a trace file is being written
+	bool IsActive() const { return Writer.IsOpen(); }
+
+	// Path of the current (or last) trace
+	FString GetPath() const { return Writer.GetPath(); }
+
+	// Events written so far
+	int32 GetEventCount() const { return EventCount; }
+
+	// One completed frame, from FCoreDelegates::OnBeginFrame to OnEndFrame
+	void AddFrame(uint64 Frame, double StartTime, double EndTime);
+
+	// A tracked input arrived and started a measurement
+	void BeginInput(const FKey& Key, double Time, uint64 Frame);
+
+	// First game-thread tick that saw the pending input
+	void MarkConsumed(double Time, uint64 Frame);
+
+	// A HUD draw that evaluated the pending input
+	void MarkDraw(double Time, uint64 Frame);
+
+	// The pending input produced a lag sample
+	void CompleteInput(double Time, uint64 Frame, float LagMs);
+
+	// The pending input was discarded without a sample (no-op if no flow is open)
+	void DropInput(double Time, uint64 Frame);
+
+private:
+	// One stage of the open flow: a short slice on Track with a flow event bound to it
+	void AddFlowStage(EInputLagTraceTrack Track, const TCHAR* StageName, TCHAR FlowPhase, double Time, uint64 Frame, const FString& ExtraArgs);
+
+	// Append one event object, handling the array separators
+	void Emit(const FString& Event);
+
+	// Trace timestamps in microseconds since Start
+	double ToMicroseconds(double Time) const { return (Time - BaseTime) * 1000000.0; }
+
+	// Off-thread file writer
+	FInputLagLogWriter Writer;
+
+	// FPlatformTime::Seconds() at Start
+	double BaseTime;
+
+	// Id of the flow currently open (0 = none) and the next one to hand out
+	uint32 OpenFlowId;
+	uint32 NextFlowId;
+
+	// Key of the open flow, for slice labels
+	FKey OpenFlowKey;
+
+	// Whether the open flow already recorded its game-thread consumption
+	bool bOpenFlowConsumed;
+
+	// Events written so far (0 until the first event, which has no leading separator)
+	int32 EventCount;
+};
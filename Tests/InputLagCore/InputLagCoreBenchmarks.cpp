@@ -0,0 +1,185 @@
+// Microbenchmarks for the engine-free InputLagCore headers
+// Reports ns per recorded sample, ns per stats read and bytes per sample of each storage format.
+// --quick runs a short pass (used by ctest to keep the suite building and running).
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "InputLagCore/InputLagCore.h"
+
+using namespace InputLagCore;
+
+namespace
+{
+	// Same shape as a session's history row and report sketch
+	const int32_t HistoryCapacity = 200;
+	const int32_t NumSketchBuckets = 64;
+
+	// Fake clock advancing a little on every read, so each record sees a fresh plausible lag
+	struct FBenchTimeSource
+	{
+		static double Time;
+		static double Now()
+		{
+			Time += 0.0001;
+			return Time;
+		}
+	};
+	double FBenchTimeSource::Time = 0.0;
+
+	// Keeps results alive so the compiler cannot drop the measured work
+	volatile float Sink = 0.0f;
+
+	struct FStopwatch
+	{
+		std::chrono::steady_clock::time_point Start;
+
+		FStopwatch()
+			: Start(std::chrono::steady_clock::now())
+		{
+		}
+
+		double GetNsPer(int64_t Count) const
+		{
+			return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - Start).count() / (double)Count;
+		}
+	};
+
+	// Lag values spread like real samples (8-60 ms)
+	float GetSampleLag(int64_t Index)
+	{
+		return 8.0f + (float)((Index * 7919) % 5200) * 0.01f;
+	}
+
+	struct FHistoryRow
+	{
+		float History[HistoryCapacity];
+		float Weights[HistoryCapacity];
+		int32_t HistoryIndex;
+		float RawLag;
+		float SmoothedLag;
+	};
+
+	void FillHistory(FHistoryRow& Row)
+	{
+		std::memset(&Row, 0, sizeof(Row));
+		for (int32_t Index = 0; Index < HistoryCapacity; ++Index)
+		{
+			RingPush(Row.History, Row.Weights, Row.HistoryIndex, HistoryCapacity, GetSampleLag(Index), 1.0f);
+		}
+	}
+}
+
+static void BenchRecord(int64_t Iterations)
+{
+	FHistoryRow Row;
+	std::memset(&Row, 0, sizeof(Row));
+	TLogHistogram<NumSketchBuckets> Sketch;
+
+	// The session's per-sample work: lag from the clock, raw/smoothed, history ring, report sketch
+	FStopwatch Stopwatch;
+	for (int64_t Index = 0; Index < Iterations; ++Index)
+	{
+		double Now;
+		float LagMs = RecordLag<FBenchTimeSource>(FBenchTimeSource::Time - GetSampleLag(Index) * 0.001, 1.0f,
+			Row.History, Row.Weights, Row.HistoryIndex, HistoryCapacity, Row.RawLag, Row.SmoothedLag, Now);
+		Sketch.Add(LagMs);
+	}
+	std::printf("record (lag + history + sketch)   %8.1f ns/sample\n", Stopwatch.GetNsPer(Iterations));
+	Sink = Row.SmoothedLag + (float)Sketch.GetTotalCount();
+}
+
+static void BenchStatsReads(int64_t Iterations)
+{
+	FHistoryRow Row;
+	FillHistory(Row);
+
+	{
+		FStopwatch Stopwatch;
+		for (int64_t Index = 0; Index < Iterations; ++Index)
+		{
+			Sink = WeightedPercentile(Row.History, Row.Weights, HistoryCapacity, 0.95f);
+		}
+		std::printf("read p95 over %d samples         %8.1f ns/read\n", HistoryCapacity, Stopwatch.GetNsPer(Iterations));
+	}
+
+	{
+		FStopwatch Stopwatch;
+		for (int64_t Index = 0; Index < Iterations; ++Index)
+		{
+			Sink = WeightedAverage(Row.History, Row.Weights, HistoryCapacity) + MinValue(Row.History, HistoryCapacity)
+				+ MaxValue(Row.History, HistoryCapacity);
+		}
+		std::printf("read avg/min/max over %d samples %8.1f ns/read\n", HistoryCapacity, Stopwatch.GetNsPer(Iterations));
+	}
+
+	TLogHistogram<NumSketchBuckets> Sketch;
+	for (int32_t Index = 0; Index < 100000; ++Index)
+	{
+		Sketch.Add(GetSampleLag(Index));
+	}
+	{
+		FStopwatch Stopwatch;
+		for (int64_t Index = 0; Index < Iterations; ++Index)
+		{
+			Sink = Sketch.GetPercentile(0.95f);
+		}
+		std::printf("read sketch p95                   %8.1f ns/read\n", Stopwatch.GetNsPer(Iterations));
+	}
+
+	// What getters pay once the stats are published as a snapshot
+	struct FSnapshot
+	{
+		float Average;
+		float Percentile95;
+	};
+	TTripleBuffer<FSnapshot> Snapshots;
+	Snapshots.GetWriteBuffer().Percentile95 = 42.0f;
+	Snapshots.Publish();
+	{
+		FStopwatch Stopwatch;
+		for (int64_t Index = 0; Index < Iterations * 100; ++Index)
+		{
+			Sink = Snapshots.Read().Percentile95;
+		}
+		std::printf("read published snapshot           %8.1f ns/read\n", Stopwatch.GetNsPer(Iterations * 100));
+	}
+}
+
+static void ReportBytesPerSample()
+{
+	// History ring: value + weight, fixed capacity
+	std::printf("history ring                      %8.1f bytes/sample (%d kept)\n",
+		(double)(sizeof(float) * 2), HistoryCapacity);
+
+	// Report sketch: fixed size however many samples it counts; on the wire at most 2 bytes per bucket
+	const int64_t ReportSamples = 1000;
+	std::printf("sketch in memory                  %8.3f bytes/sample (%d bytes, %lld samples)\n",
+		(double)sizeof(TLogHistogram<NumSketchBuckets>) / ReportSamples, (int32_t)sizeof(TLogHistogram<NumSketchBuckets>), (long long)ReportSamples);
+	std::printf("sketch report on the wire         %8.3f bytes/sample (at most %d bytes per report)\n",
+		(double)(NumSketchBuckets * 2) / ReportSamples, NumSketchBuckets * 2);
+
+	// Session log row before compression
+	const int32_t NumRows = 10000;
+	int64_t TotalBytes = 0;
+	char Row[256];
+	for (int32_t Index = 0; Index < NumRows; ++Index)
+	{
+		TotalBytes += EncodeCsvRow(Row, sizeof(Row), "2026-01-02 03:04:05.678", 100000 + Index, GetSampleLag(Index),
+			(Index & 1) ? "MouseX" : "LeftMouseButton", (float)(Index % 100) * 0.01f, 3.25f, 2);
+	}
+	std::printf("CSV log row (uncompressed)        %8.1f bytes/sample\n", (double)TotalBytes / NumRows);
+}
+
+int main(int argc, char** argv)
+{
+	bool bQuick = (argc > 1 && std::strcmp(argv[1], "--quick") == 0);
+	int64_t RecordIterations = bQuick ? 100000 : 20000000;
+	int64_t ReadIterations = bQuick ? 1000 : 200000;
+
+	BenchRecord(RecordIterations);
+	BenchStatsReads(ReadIterations);
+	ReportBytesPerSample();
+	return 0;
+}
@@ -0,0 +1,361 @@
+// Unit tests for the engine-free InputLagCore headers (no engine, no test framework)
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "InputLagCore/InputLagCore.h"
+
+using namespace InputLagCore;
+
+namespace
+{
+	int32_t NumChecks = 0;
+	int32_t NumFailures = 0;
+
+	void ReportCheck(bool bPassed, const char* Expression, const char* File, int32_t Line)
+	{
+		NumChecks++;
+		if (!bPassed)
+		{
+			NumFailures++;
+			std::printf("%s:%d: check failed: %s\n", File, Line, Expression);
+		}
+	}
+
+	// Fake clock for the time-source parameter
+	struct FFakeTimeSource
+	{
+		static double Time;
+		static double Now() { return Time; }
+	};
+	double FFakeTimeSource::Time = 0.0;
+}
+
+#define CHECK(Expression) ReportCheck(!!(Expression), #Expression, __FILE__, __LINE__)
+#define CHECK_NEAR(Value, Expected, Tolerance) ReportCheck(std::fabs((double)(Value) - (double)(Expected)) <= (Tolerance), #Value " ~= " #Expected, __FILE__, __LINE__)
+
+static void TestStats()
+{
+	// Equal weights: the ceil(N * p) - 1 sample in value order, empty slots skipped
+	std::vector<float> Values;
+	for (int32_t Index = 100; Index >= 1; --Index)
+	{
+		Values.push_back((float)Index);
+		Values.push_back(0.0f);
+	}
+	CHECK(WeightedPercentile(Values.data(), nullptr, (int32_t)Values.size(), 0.5f) == 50.0f);
+	CHECK(WeightedPercentile(Values.data(), nullptr, (int32_t)Values.size(), 0.95f) == 95.0f);
+	CHECK(WeightedPercentile(Values.data(), nullptr, (int32_t)Values.size(), 1.0f) == 100.0f);
+	CHECK_NEAR(WeightedAverage(Values.data(), nullptr, (int32_t)Values.size()), 50.5, 1e-4);
+	CHECK(MinValue(Values.data(), (int32_t)Values.size()) == 1.0f);
+	CHECK(MaxValue(Values.data(), (int32_t)Values.size()) == 100.0f);
+
+	// A sample taken one in three stands for three samples
+	const float Weighted[] = { 10.0f, 20.0f };
+	const float Weights[] = { 3.0f, 1.0f };
+	CHECK(WeightedPercentile(Weighted, Weights, 2, 0.5f) == 10.0f);
+	CHECK(WeightedPercentile(Weighted, Weights, 2, 0.9f) == 20.0f);
+	CHECK_NEAR(WeightedAverage(Weighted, Weights, 2), 12.5, 1e-6);
+
+	// All slots empty
+	const float Empty[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	CHECK(WeightedPercentile(Empty, nullptr, 4, 0.95f) == 0.0f);
+	CHECK(WeightedAverage(Empty, nullptr, 4) == 0.0f);
+	CHECK(MinValue(Empty, 4) == 0.0f);
+	CHECK(MaxValue(Empty, 4) == 0.0f);
+}
+
+static void TestRing()
+{
+	float Values[3] = {};
+	float Weights[3] = {};
+	int32_t Index = 0;
+
+	RingPush(Values, Weights, Index, 3, 1.0f, 1.0f);
+	RingPush(Values, Weights, Index, 3, 2.0f, 2.0f);
+	CHECK(Index == 2);
+	CHECK(RingLast(Values, Index, 3) == 2.0f);
+
+	// Wraps over the oldest sample
+	RingPush(Values, Weights, Index, 3, 3.0f, 1.0f);
+	RingPush(Values, Weights, Index, 3, 4.0f, 4.0f);
+	CHECK(Index == 1);
+	CHECK(RingLast(Values, Index, 3) == 4.0f);
+	CHECK(Values[0] == 4.0f && Weights[0] == 4.0f);
+	CHECK(Values[1] == 2.0f && Values[2] == 3.0f);
+}
+
+static void TestHistogram()
+{
+	typedef TLogHistogram<64> FHistogram;
+
+	// Under/overflow buckets and a monotonic layout in between
+	CHECK(FHistogram::GetBucket(0.0f) == 0);
+	CHECK(FHistogram::GetBucket(0.49f) == 0);
+	CHECK(FHistogram::GetBucket(0.5f) == 1);
+	CHECK(FHistogram::GetBucket(1000.0f) == 63);
+	CHECK(FHistogram::GetBucket(5000.0f) == 63);
+	int32_t PreviousBucket = 0;
+	for (float LagMs = 0.5f; LagMs < 1000.0f; LagMs *= 1.01f)
+	{
+		int32_t Bucket = FHistogram::GetBucket(LagMs);
+		CHECK(Bucket >= PreviousBucket && Bucket >= 1 && Bucket <= 62);
+		PreviousBucket = Bucket;
+	}
+
+	// Percentiles are accurate to the bucket width (about 13%)
+	FHistogram Histogram;
+	CHECK(Histogram.GetPercentile(0.5f) == 0.0f);
+	for (int32_t Index = 1; Index <= 100; ++Index)
+	{
+		Histogram.Add((float)Index);
+	}
+	CHECK(Histogram.GetTotalCount() == 100);
+	CHECK_NEAR(Histogram.GetPercentile(0.5f), 50.0, 50.0 * 0.14);
+	CHECK_NEAR(Histogram.GetPercentile(0.95f), 95.0, 95.0 * 0.14);
+
+	// Merging adds counts; taking removes at most what is there
+	FHistogram Other;
+	Other.Add(20.0f, 5);
+	Histogram.Merge(Other);
+	CHECK(Histogram.GetTotalCount() == 105);
+	int32_t Bucket = FHistogram::GetBucket(20.0f);
+	uint64_t BucketCount = Histogram.GetCount(Bucket);
+	CHECK(Histogram.TakeFromBucket(Bucket, 1000) == BucketCount);
+	CHECK(Histogram.GetCount(Bucket) == 0);
+	CHECK(Histogram.GetTotalCount() == 105 - BucketCount);
+
+	Histogram.Reset();
+	CHECK(Histogram.GetTotalCount() == 0);
+}
+
+static void TestEventQueue()
+{
+	TSpscQueue<int32_t, 4> Queue;
+	int32_t Value = 0;
+	CHECK(!Queue.Pop(Value));
+
+	// A full queue rejects instead of overwriting
+	for (int32_t Index = 0; Index < 4; ++Index)
+	{
+		CHECK(Queue.Push(Index));
+	}
+	CHECK(!Queue.Push(4));
+	CHECK(Queue.Num() == 4);
+	for (int32_t Index = 0; Index < 4; ++Index)
+	{
+		CHECK(Queue.Pop(Value) && Value == Index);
+	}
+	CHECK(Queue.Num() == 0);
+
+	// One producer and one consumer thread: every event arrives once and in order
+	const int32_t NumEvents = 200000;
+	TSpscQueue<int32_t, 1024> SharedQueue;
+	std::thread Producer([&SharedQueue, NumEvents]()
+	{
+		for (int32_t Index = 0; Index < NumEvents; )
+		{
+			if (SharedQueue.Push(Index))
+			{
+				Index++;
+			}
+		}
+	});
+
+	int32_t Expected = 0;
+	bool bInOrder = true;
+	while (Expected < NumEvents)
+	{
+		int32_t Event;
+		if (SharedQueue.Pop(Event))
+		{
+			bInOrder = bInOrder && (Event == Expected);
+			Expected++;
+		}
+	}
+	Producer.join();
+	CHECK(bInOrder);
+	CHECK(!SharedQueue.Pop(Value));
+}
+
+static void TestTripleBuffer()
+{
+	TTripleBuffer<int32_t> Buffer;
+
+	Buffer.GetWriteBuffer() = 1;
+	Buffer.Publish();
+	CHECK(Buffer.GetPublished() == 1);
+	CHECK(Buffer.Read() == 1);
+
+	// The reader only ever sees the latest snapshot
+	Buffer.GetWriteBuffer() = 2;
+	Buffer.Publish();
+	Buffer.GetWriteBuffer() = 3;
+	Buffer.Publish();
+	CHECK(Buffer.Read() == 3);
+	CHECK(Buffer.Read() == 3);
+	CHECK(Buffer.GetPublished() == 3);
+
+	// One producer publishing while several readers (render thread, UMG, exporters) copy the latest
+	// snapshot: no reader sees a torn snapshot, and none sees the snapshots go backwards
+	struct FSnapshot
+	{
+		uint64_t Sequence;
+		uint64_t Derived[7];
+	};
+	const uint64_t NumPublishes = 200000;
+	const int32_t NumReaders = 3;
+	TTripleBuffer<FSnapshot> Shared;
+	std::atomic<bool> bDone(false);
+	std::atomic<int32_t> NumTorn(0);
+	std::atomic<int32_t> NumBackwards(0);
+	std::atomic<uint64_t> NumReads(0);
+	std::atomic<int32_t> NumReadersStarted(0);
+
+	std::vector<std::thread> Readers;
+	for (int32_t Reader = 0; Reader < NumReaders; ++Reader)
+	{
+		Readers.push_back(std::thread([&]()
+		{
+			uint64_t LastSequence = 0;
+			uint64_t Reads = 0;
+			NumReadersStarted++;
+			while (!bDone.load(std::memory_order_acquire))
+			{
+				FSnapshot Snapshot = Shared.Read();
+				for (int32_t Index = 0; Index < 7; ++Index)
+				{
+					if (Snapshot.Derived[Index] != Snapshot.Sequence * (Index + 2))
+					{
+						NumTorn++;
+						break;
+					}
+				}
+				if (Snapshot.Sequence < LastSequence)
+				{
+					NumBackwards++;
+				}
+				LastSequence = Snapshot.Sequence;
+				Reads++;
+			}
+			NumReads += Reads;
+		}));
+	}
+
+	while (NumReadersStarted.load() < NumReaders)
+	{
+		std::this_thread::yield();
+	}
+	for (uint64_t Sequence = 1; Sequence <= NumPublishes; ++Sequence)
+	{
+		FSnapshot& Snapshot = Shared.GetWriteBuffer();
+		Snapshot.Sequence = Sequence;
+		for (int32_t Index = 0; Index < 7; ++Index)
+		{
+			Snapshot.Derived[Index] = Sequence * (Index + 2);
+		}
+		Shared.Publish();
+	}
+	bDone.store(true, std::memory_order_release);
+	for (std::thread& Reader : Readers)
+	{
+		Reader.join();
+	}
+
+	CHECK(NumTorn.load() == 0);
+	CHECK(NumBackwards.load() == 0);
+	CHECK(NumReads.load() >= (uint64_t)NumReaders);
+	CHECK(Shared.Read().Sequence == NumPublishes);
+}
+
+static void TestEncoding()
+{
+	uint8_t Bytes[LogIndexEntrySize];
+
+	CHECK(EncodeLogBlockHeader(Bytes, 0x01020304, 0x0A0B0C0D) == LogBlockHeaderSize);
+	const uint8_t ExpectedHeader[] = { 'I', 'L', 'B', '1', 0x04, 0x03, 0x02, 0x01, 0x0D, 0x0C, 0x0B, 0x0A };
+	CHECK(std::memcmp(Bytes, ExpectedHeader, sizeof(ExpectedHeader)) == 0);
+
+	CHECK(EncodeLogIndexEntry(Bytes, 0x1122334455667788LL, 1.5, 7, 9) == LogIndexEntrySize);
+	CHECK(Bytes[0] == 0x88 && Bytes[7] == 0x11);
+	double Timestamp;
+	std::memcpy(&Timestamp, Bytes + 8, sizeof(Timestamp));
+	CHECK(Timestamp == 1.5);
+	CHECK(Bytes[16] == 7 && Bytes[20] == 9);
+
+	CHECK(EncodeLogTrailer(Bytes, 3, 1000) == LogTrailerSize);
+	CHECK(Bytes[0] == 3 && Bytes[4] == 0xE8 && Bytes[5] == 0x03);
+	CHECK(std::memcmp(Bytes + 12, "ILIX", 4) == 0);
+
+	// CSV row matches the header's columns
+	char Row[128];
+	int32_t Length = EncodeCsvRow(Row, sizeof(Row), "2026-01-02 03:04:05.678", 1234, 16.5f, "MouseX", 0.25f, 2.0f, 2);
+	CHECK(std::string(Row) == "2026-01-02 03:04:05.678,1234,16.500,MouseX,0.250,2.000,2\n");
+	CHECK(Length == (int32_t)std::strlen(Row));
+
+	std::string Header = GetCsvHeader();
+	CHECK(Header.back() == '\n');
+	CHECK(std::count(Header.begin(), Header.end(), ',') == std::count(Row, Row + Length, ','));
+
+	// A row that does not fit is refused rather than cut short
+	char Small[16];
+	CHECK(EncodeCsvRow(Small, sizeof(Small), "2026-01-02 03:04:05.678", 1234, 16.5f, "MouseX", 0.25f, 2.0f, 2) == -1);
+}
+
+static void TestMeasurement()
+{
+	float History[4] = {};
+	float Weights[4] = {};
+	int32_t HistoryIndex = 0;
+	float RawLag = 0.0f;
+	float SmoothedLag = 0.0f;
+	double Now = 0.0;
+
+	// Lag is read from the time source; the first sample seeds the smoothed value
+	FFakeTimeSource::Time = 10.020;
+	float LagMs = RecordLag<FFakeTimeSource>(10.0, 2.0f, History, Weights, HistoryIndex, 4, RawLag, SmoothedLag, Now);
+	CHECK_NEAR(LagMs, 20.0, 1e-3);
+	CHECK(Now == 10.020);
+	CHECK(RawLag == LagMs && SmoothedLag == LagMs);
+	CHECK(HistoryIndex == 1 && History[0] == LagMs && Weights[0] == 2.0f);
+
+	FFakeTimeSource::Time = 11.010;
+	LagMs = RecordLag<FFakeTimeSource>(11.0, 1.0f, History, Weights, HistoryIndex, 4, RawLag, SmoothedLag, Now);
+	CHECK_NEAR(LagMs, 10.0, 1e-3);
+	CHECK_NEAR(SmoothedLag, 19.0, 1e-3);
+
+	// Implausible samples leave everything alone
+	FFakeTimeSource::Time = 13.0;
+	CHECK(RecordLag<FFakeTimeSource>(11.0, 1.0f, History, Weights, HistoryIndex, 4, RawLag, SmoothedLag, Now) < 0.0f);
+	FFakeTimeSource::Time = 10.0;
+	CHECK(RecordLag<FFakeTimeSource>(11.0, 1.0f, History, Weights, HistoryIndex, 4, RawLag, SmoothedLag, Now) < 0.0f);
+	CHECK(HistoryIndex == 2);
+	CHECK_NEAR(RawLag, 10.0, 1e-3);
+
+	// Arrival phase within the frame
+	CHECK(GetArrivalPhase(1.5, 1.0, 2.0) == 0.5f);
+	CHECK(GetArrivalPhase(0.5, 1.0, 2.0) == 0.0f);
+	CHECK(GetArrivalPhase(2.5, 1.0, 2.0) == 1.0f);
+	CHECK(GetArrivalPhase(1.5, 1.0, 0.0) == -1.0f);
+	CHECK(GetArrivalPhase(1.5, 0.0, 2.0) == -1.0f);
+}
+
+int main()
+{
+	TestStats();
+	TestRing();
+	TestHistogram();
+	TestEventQueue();
+	TestTripleBuffer();
+	TestEncoding();
+	TestMeasurement();
+
+	std::printf("%d checks, %d failed\n", NumChecks, NumFailures);
+	return NumFailures == 0 ? 0 : 1;
+}